@@ -2,7 +2,18 @@
 #include "ap_int.h"
 #include "ap_axi_sdata.h"
 
+// Two-stage (cascade) inference
+// Stage one is a 1-neuron linear screen, run on every datapoint
+// Only datapoints whose screen score falls inside the uncertainty band [band_low, band_high] go through the hidden and output layers
+// Each output word is tagged with the stage that decided it
+// Must match the testbench and the PS application, define here or pass -DCASCADE_MODE to both
+//#define CASCADE_MODE
+
+#ifdef CASCADE_MODE
+#define NUMBER_OF_INPUT_WORDS 477	// A, B, C, then S (screen weights) and the uncertainty band
+#else
 #define NUMBER_OF_INPUT_WORDS 467
+#endif
 #define NUMBER_OF_OUTPUT_WORDS 64
 
 #define A_NUM_ROWS 64
@@ -26,9 +37,81 @@
 #define NUM_NEURONS_HIDDEN_LAYER 2
 #define NUM_NEURONS_OUTPUT_LAYER 1
 
+#define S_NUM_ROWS 8				// 7(weight connections) + 1(bias) of the screen neuron
+#define S_NUM_COLS 1
+#define S_DISREGARD_BIAS_TERM 1
+#define BAND_NUM_WORDS 2			// Lower and upper bound (inclusive) of the uncertainty band
+#define CASCADE_STAGE_SCREEN 1
+#define CASCADE_STAGE_FULL 2
+#define CASCADE_STAGE_SHIFT 8		// Output word is (stage << 8) | result
+
+// Bit-serial, low area variant of the hidden and output layers
+// Instead of 8x8 multipliers, each lane ANDs one bit-plane of the features with the weights and accumulates the shifted partial sum
+// BIT_SERIAL_LANES datapoints are processed in parallel, one bit-plane per cycle, so per-datapoint latency is 8+8 cycles
+// Must match the testbench, define here or pass -DBIT_SERIAL_KERNEL to both
+//#define BIT_SERIAL_KERNEL
+// Lanes trade area for throughput, pass -DBIT_SERIAL_LANES=<1, 2, 4 or 8> to both. Per setting, from the loop structure:
+//   Lanes   recv_a_matrix banks   Hidden layer adders   Output layer adders   Pipelined bit-plane iterations per batch
+//     1              7                 2x7 (11 bit)          2 (9 bit)             64*(8+8) = 1024
+//     2             14                 4x7                   4                     32*(8+8) =  512
+//     4             28                 8x7                   8                     16*(8+8) =  256
+//     8             56                16x7                  16                      8*(8+8) =  128
+// Stream in/out (NUMBER_OF_INPUT_WORDS + NUMBER_OF_OUTPUT_WORDS cycles) comes on top, LUT/FF/DSP and the latency are in csynth.rpt
+// The parallel variant uses 2 multipliers. Beyond 2 lanes the adders and banks are likely to cost more than that, so 2 is the default
+#ifndef BIT_SERIAL_LANES
+#define BIT_SERIAL_LANES 2
+#endif
+// BIT_SERIAL_LANES*A_NUM_COLS, banks of recv_a_matrix read per cycle, a plain number for the pragma
+#if BIT_SERIAL_LANES == 1
+#define BIT_SERIAL_PARTITION 7
+#elif BIT_SERIAL_LANES == 2
+#define BIT_SERIAL_PARTITION 14
+#elif BIT_SERIAL_LANES == 4
+#define BIT_SERIAL_PARTITION 28
+#elif BIT_SERIAL_LANES == 8
+#define BIT_SERIAL_PARTITION 56
+#else
+#error "BIT_SERIAL_LANES must be 1, 2, 4 or 8"
+#endif
+#define BIT_SERIAL_PLANES 8			// Features and hidden neurons are 8 bit
+
+#if defined(BIT_SERIAL_KERNEL) && defined(CASCADE_MODE)
+#error "BIT_SERIAL_KERNEL processes fixed groups of datapoints, it cannot run on the compacted rows of CASCADE_MODE"
+#endif
+
+// Online weight update (one fixed-point SGD step per training transaction), weights stay resident in the coprocessor
+// Every transaction then starts with an opcode word
+//  - OPCODE_INFER:            A, B, C             --> 64 results. B, C become the resident weights
+//  - OPCODE_INFER_RESIDENT:   A                   --> 64 results, using the resident weights
+//  - OPCODE_TRAIN:            A, 64 labels (0/1)  --> updated B, C, then sum of |error| over the batch
+//  - OPCODE_READ_WEIGHTS:                         --> resident B, C
+// Must match the testbench, define here or pass -DONLINE_TRAINING to both
+//#define ONLINE_TRAINING
+#define OPCODE_INFER 0
+#define OPCODE_INFER_RESIDENT 1
+#define OPCODE_TRAIN 2
+#define OPCODE_READ_WEIGHTS 3
+#define OPCODE_MASK 0xFF				// Upper bits of the opcode word are free for the PS (its model handle), ignored here
+#define NUMBER_OF_WEIGHT_WORDS 19		// B_NUM_ROWS*B_NUM_COLS + C_NUM_ROWS*C_NUM_COLS
+#define NUMBER_OF_LABEL_WORDS 64		// Same layout as Proj/Dataset/labels.csv, one per datapoint
+#define TRAIN_TARGET_NEGATIVE 32		// Output neuron target for label 0
+#define TRAIN_TARGET_POSITIVE 64		// Output neuron target for label 1
+#define TRAIN_LR_SHIFT_OUTPUT 15		// Learning rate of C, as a right shift of the accumulated gradient
+#define TRAIN_LR_SHIFT_HIDDEN 22		// Learning rate of B, as a right shift of the accumulated gradient
+
+#if defined(ONLINE_TRAINING) && defined(CASCADE_MODE)
+#error "ONLINE_TRAINING does not keep the screen weights of CASCADE_MODE resident"
+#endif
+
 ap_uint<8> hidden_layer_neurons[NUM_NEURONS_HIDDEN_LAYER][A_NUM_ROWS];
 ap_uint<8> output_layer_neurons[A_NUM_ROWS];
 
+#ifdef ONLINE_TRAINING
+// Weights kept across transactions
+ap_uint<8> resident_b_matrix[B_NUM_ROWS*B_NUM_COLS];
+ap_uint<8> resident_c_matrix[C_NUM_ROWS*C_NUM_COLS];
+#endif
+
 
 // ACLK, ARESETN, TREADY, TDATA, TVALID are essential signals for AXIS.
 // TLAST is a sideband signal which is optional in AXIS.
@@ -38,6 +121,11 @@ ap_uint<8> output_layer_neurons[A_NUM_ROWS];
 // Declare an AXI-4 Stream interface (without side-channels)
 typedef ap_axis<32,0,0,0> AXIS_wLAST;
 
+#ifdef ONLINE_TRAINING
+void myip_v1_0_HLS_transmit_weights(hls::stream<AXIS_wLAST>& M_AXIS, bool last);
+void myip_v1_0_HLS_train(hls::stream<AXIS_wLAST>& S_AXIS, hls::stream<AXIS_wLAST>& M_AXIS);
+#endif
+
 // https://docs.amd.com/r/en-US/ug1399-vitis-hls/Interfaces-for-Vitis-Kernel-Flow
 // https://docs.amd.com/r/en-US/ug1399-vitis-hls/AXI4-Stream-Interfaces
 // Since we are using AXI-4 Stream interface protocol, the argument is hls::stream (Paradigm is Stream)
@@ -54,14 +142,47 @@ void myip_v1_0_HLS(hls::stream<AXIS_wLAST>& S_AXIS, hls::stream<AXIS_wLAST>& M_A
 	ap_uint<8> recv_a_matrix[A_NUM_ROWS*A_NUM_COLS] = {0};
 	ap_uint<8> recv_b_matrix[B_NUM_ROWS*B_NUM_COLS] = {0};
     ap_uint<8> recv_c_matrix[C_NUM_ROWS*C_NUM_COLS] = {0};
+#ifdef CASCADE_MODE
+	ap_uint<8> recv_s_matrix[S_NUM_ROWS*S_NUM_COLS] = {0};
+	ap_uint<8> recv_band[BAND_NUM_WORDS] = {0};
+	ap_uint<2> decided_stage[A_NUM_ROWS];
+	ap_uint<7> full_rows[A_NUM_ROWS];		// Datapoints which go through the full MLP
+	int num_full_rows = 0;
+#endif
+#ifdef BIT_SERIAL_KERNEL
+	// Every lane reads all 7 features and all weights in the same cycle
+	#pragma HLS ARRAY_PARTITION variable=recv_a_matrix cyclic factor=BIT_SERIAL_PARTITION
+	#pragma HLS ARRAY_PARTITION variable=recv_b_matrix complete
+	#pragma HLS ARRAY_PARTITION variable=recv_c_matrix complete
+#endif
 
 	AXIS_wLAST read_input;
 	AXIS_wLAST write_output;
 
+#ifdef ONLINE_TRAINING
+	/**************************** DECODE OPCODE ************************************/
+	ap_uint<32> opcode = S_AXIS.read().data & OPCODE_MASK;
+
+	if (opcode == OPCODE_TRAIN) {
+		myip_v1_0_HLS_train(S_AXIS, M_AXIS);
+		return;
+	}
+	if (opcode == OPCODE_READ_WEIGHTS) {
+		myip_v1_0_HLS_transmit_weights(M_AXIS, true);
+		return;
+	}
+
+	// OPCODE_INFER_RESIDENT only carries the A matrix
+	int num_input_words = (opcode == OPCODE_INFER_RESIDENT) ? A_NUM_ROWS*A_NUM_COLS : NUMBER_OF_INPUT_WORDS;
+#else
+	int num_input_words = NUMBER_OF_INPUT_WORDS;
+#endif
+
     /**************************** RECEIVE DATA ************************************/
 	// We are not making using of S_TLAST (from Master) when Coprocessor (Slave) receives Data
 	// S_AXIS_TLAST is required only when we are receiving an unknown number of words.
-	myip_v1_0_HLS_receive:for(int word_cnt = 0; word_cnt < NUMBER_OF_INPUT_WORDS; word_cnt++) {
+	myip_v1_0_HLS_receive:for(int word_cnt = 0; word_cnt < num_input_words; word_cnt++) {
+		#pragma HLS LOOP_TRIPCOUNT min=448 max=477
 		// read_input is the element (data + other signals) received by our IP through S_AXIS in one clock cycle (which contains one word).
 		// read() extracts it from the stream. Overloaded operator >> can also be used.
 		read_input = S_AXIS.read();
@@ -73,14 +194,131 @@ void myip_v1_0_HLS(hls::stream<AXIS_wLAST>& S_AXIS, hls::stream<AXIS_wLAST>& M_A
 				&& word_cnt < A_NUM_ROWS*A_NUM_COLS + B_NUM_ROWS*B_NUM_COLS) {
 			recv_b_matrix[word_cnt-(A_NUM_ROWS*A_NUM_COLS)] = read_input.data;
 		}
-        else {
+        else if (word_cnt < A_NUM_ROWS*A_NUM_COLS + B_NUM_ROWS*B_NUM_COLS + C_NUM_ROWS*C_NUM_COLS) {
             recv_c_matrix[word_cnt-(A_NUM_ROWS*A_NUM_COLS)-(B_NUM_ROWS*B_NUM_COLS)] = read_input.data;
         }
+#ifdef CASCADE_MODE
+		else if (word_cnt < A_NUM_ROWS*A_NUM_COLS + B_NUM_ROWS*B_NUM_COLS + C_NUM_ROWS*C_NUM_COLS + S_NUM_ROWS*S_NUM_COLS) {
+			recv_s_matrix[word_cnt-(A_NUM_ROWS*A_NUM_COLS)-(B_NUM_ROWS*B_NUM_COLS)-(C_NUM_ROWS*C_NUM_COLS)] = read_input.data;
+		}
+		else {
+			recv_band[word_cnt-(A_NUM_ROWS*A_NUM_COLS)-(B_NUM_ROWS*B_NUM_COLS)-(C_NUM_ROWS*C_NUM_COLS)-(S_NUM_ROWS*S_NUM_COLS)] = read_input.data;
+		}
+#endif
 	}
 
+#ifdef ONLINE_TRAINING
+	// Either take the received weights as the new resident ones, or infer with the resident ones
+	myip_v1_0_HLS_resident_b:for (int k = 0; k < B_NUM_ROWS*B_NUM_COLS; k++) {
+		if (opcode == OPCODE_INFER) resident_b_matrix[k] = recv_b_matrix[k];
+		else recv_b_matrix[k] = resident_b_matrix[k];
+	}
+	myip_v1_0_HLS_resident_c:for (int k = 0; k < C_NUM_ROWS*C_NUM_COLS; k++) {
+		if (opcode == OPCODE_INFER) resident_c_matrix[k] = recv_c_matrix[k];
+		else recv_c_matrix[k] = resident_c_matrix[k];
+	}
+#endif
+
+
+#ifdef CASCADE_MODE
+	/**************************** STAGE ONE: LINEAR SCREEN ************************************/
+	// Confident datapoints are decided here, the uncertain ones are queued for the full MLP
+	myip_v1_0_HLS_screen:for (int i = 0; i < A_NUM_ROWS; i++) {
+		ap_uint<32> score = 0;
 
+		for (int j = 0; j < A_NUM_COLS; j++) {
+			score += recv_a_matrix[(i*A_NUM_COLS) + (j)] * recv_s_matrix[S_DISREGARD_BIAS_TERM + j];
+		}
+		score += recv_s_matrix[0];
+		score = score >> NUM_FRACTIONAL_BITS;
+
+		if (recv_band[0] <= score && score <= recv_band[1]) {
+			decided_stage[i] = CASCADE_STAGE_FULL;
+			full_rows[num_full_rows] = i;
+			num_full_rows++;
+		}
+		else {
+			decided_stage[i] = CASCADE_STAGE_SCREEN;
+			output_layer_neurons[i] = (score > 255) ? (ap_uint<32>)255 : score;
+		}
+	}
+#endif
+
+
+#ifdef BIT_SERIAL_KERNEL
+    /**************************** COMPUTE HIDDEN + OUTPUT LAYER, BIT-SERIAL ************************************/
+	myip_v1_0_HLS_bit_serial_groups:for (int i0 = 0; i0 < A_NUM_ROWS; i0 += BIT_SERIAL_LANES) {
+		ap_uint<32> sum_1[BIT_SERIAL_LANES];	// First neuron of hidden layer
+		ap_uint<32> sum_2[BIT_SERIAL_LANES];	// Second neuron of hidden layer
+		ap_uint<32> sum[BIT_SERIAL_LANES];		// Output neuron
+		#pragma HLS ARRAY_PARTITION variable=sum_1 complete
+		#pragma HLS ARRAY_PARTITION variable=sum_2 complete
+		#pragma HLS ARRAY_PARTITION variable=sum complete
+
+		// Start from the bias terms
+		myip_v1_0_HLS_bit_serial_init:for (int l = 0; l < BIT_SERIAL_LANES; l++) {
+			#pragma HLS UNROLL
+			sum_1[l] = recv_b_matrix[HIDDEN_LAYER_FIRST_NEURON];
+			sum_2[l] = recv_b_matrix[HIDDEN_LAYER_SECOND_NEURON];
+			sum[l] = recv_c_matrix[0];
+		}
+
+		// Hidden layer, bit-plane b of all 7 features of every lane in one cycle
+		// x*w = sum over b of (x[b] ? w : 0) << b
+		myip_v1_0_HLS_bit_serial_hidden:for (int b = 0; b < BIT_SERIAL_PLANES; b++) {
+			#pragma HLS PIPELINE II=1
+			for (int l = 0; l < BIT_SERIAL_LANES; l++) {
+				#pragma HLS UNROLL
+				ap_uint<11> partial_1 = 0;	// Maximally 7*255
+				ap_uint<11> partial_2 = 0;
+
+				for (int j = 0; j < A_NUM_COLS; j++) {
+					#pragma HLS UNROLL
+					if (recv_a_matrix[((i0+l)*A_NUM_COLS) + (j)][b]) {
+						partial_1 += recv_b_matrix[B_DISREGARD_BIAS_TERM + (j*NUM_NEURONS_HIDDEN_LAYER)];
+						partial_2 += recv_b_matrix[B_DISREGARD_BIAS_TERM + B_OFFSET_FOR_SECOND_NEURON + (j*NUM_NEURONS_HIDDEN_LAYER)];
+					}
+				}
+
+				sum_1[l] += (ap_uint<32>)partial_1 << b;
+				sum_2[l] += (ap_uint<32>)partial_2 << b;
+			}
+		}
+
+		// Output layer, bit-plane b of both hidden neurons of every lane in one cycle
+		myip_v1_0_HLS_bit_serial_output:for (int b = 0; b < BIT_SERIAL_PLANES; b++) {
+			#pragma HLS PIPELINE II=1
+			for (int l = 0; l < BIT_SERIAL_LANES; l++) {
+				#pragma HLS UNROLL
+				// Restore precision of the hidden layer neurons, same truncation to 8 bits as the parallel variant
+				ap_uint<8> hidden_1 = sum_1[l] >> NUM_FRACTIONAL_BITS;
+				ap_uint<8> hidden_2 = sum_2[l] >> NUM_FRACTIONAL_BITS;
+				ap_uint<9> partial = 0;		// Maximally 2*255
+
+				if (hidden_1[b]) partial += recv_c_matrix[C_DISREGARD_BIAS_TERM];
+				if (hidden_2[b]) partial += recv_c_matrix[C_DISREGARD_BIAS_TERM + 1];
+
+				sum[l] += (ap_uint<32>)partial << b;
+			}
+		}
+
+		myip_v1_0_HLS_bit_serial_store:for (int l = 0; l < BIT_SERIAL_LANES; l++) {
+			#pragma HLS UNROLL
+			hidden_layer_neurons[HIDDEN_LAYER_FIRST_NEURON][i0+l] = (sum_1[l] >> NUM_FRACTIONAL_BITS);
+			hidden_layer_neurons[HIDDEN_LAYER_SECOND_NEURON][i0+l] = (sum_2[l] >> NUM_FRACTIONAL_BITS);
+			output_layer_neurons[i0+l] = (sum[l] >> NUM_FRACTIONAL_BITS);
+		}
+	}
+#else
     /**************************** COMPUTE HIDDEN LAYER ************************************/
+#ifdef CASCADE_MODE
+    // Stage two, only the uncertain datapoints
+    myip_v1_0_HLS_inference_hidden_Layer:for(int k = 0; k < num_full_rows; k++) {
+		#pragma HLS LOOP_TRIPCOUNT min=0 max=64
+		int i = full_rows[k];
+#else
     myip_v1_0_HLS_inference_hidden_Layer:for(int i = 0; i < A_NUM_ROWS; i++) {
+#endif
         ap_uint<32> sum_1 = 0;  // First neuron of hidden layer
         ap_uint<32> sum_2 = 0;  // Second neuron of hidden layer
 
@@ -106,7 +344,13 @@ void myip_v1_0_HLS(hls::stream<AXIS_wLAST>& S_AXIS, hls::stream<AXIS_wLAST>& M_A
 
 	/**************************** COMPUTE OUTPUT LAYER ************************************/
     // Iterate through 'A_NUM_ROWS' datapoints from BOTH neurons simultaneously
+#ifdef CASCADE_MODE
+    myip_v1_0_HLS_inference_output_layer:for (int k = 0; k < num_full_rows; k++) {
+		#pragma HLS LOOP_TRIPCOUNT min=0 max=64
+		int i = full_rows[k];
+#else
     myip_v1_0_HLS_inference_output_layer:for (int i = 0; i < A_NUM_ROWS; i++) {
+#endif
 
         ap_uint<32> sum = 0;
 
@@ -123,6 +367,7 @@ void myip_v1_0_HLS(hls::stream<AXIS_wLAST>& S_AXIS, hls::stream<AXIS_wLAST>& M_A
         // Note output neuron has linear activation function
         output_layer_neurons[i] =  (sum >> NUM_FRACTIONAL_BITS);
     }
+#endif
 
 
 	myip_v1_0_HLS_transmit:for(int word_cnt = 0; word_cnt < NUMBER_OF_OUTPUT_WORDS; word_cnt++) {
@@ -132,7 +377,11 @@ void myip_v1_0_HLS(hls::stream<AXIS_wLAST>& S_AXIS, hls::stream<AXIS_wLAST>& M_A
 		write_output.last = (word_cnt==NUMBER_OF_OUTPUT_WORDS-1) ? 1 : 0;
 
 		// write_output is the element sent by our IP through M_AXIS in one clock cycle.
+#ifdef CASCADE_MODE
+		write_output.data = ((ap_uint<32>)decided_stage[word_cnt] << CASCADE_STAGE_SHIFT) | output_layer_neurons[word_cnt];
+#else
 		write_output.data = output_layer_neurons[word_cnt];
+#endif
 
 		// write() inserts it into the stream. Overloaded operator << can also be used.
 		M_AXIS.write(write_output);
@@ -140,4 +389,111 @@ void myip_v1_0_HLS(hls::stream<AXIS_wLAST>& S_AXIS, hls::stream<AXIS_wLAST>& M_A
 
 	// De-pulse M_TLAST
 	write_output.last = 0;
-}
\ No newline at end of file
+}
+
+
+#ifdef ONLINE_TRAINING
+/**************************** ONLINE TRAINING ************************************/
+void myip_v1_0_HLS_transmit_weights(hls::stream<AXIS_wLAST>& M_AXIS, bool last) {
+	AXIS_wLAST write_output;
+
+	// Same order as they are received, B then C
+	myip_v1_0_HLS_transmit_weights:for (int word_cnt = 0; word_cnt < NUMBER_OF_WEIGHT_WORDS; word_cnt++) {
+		write_output.last = (last && word_cnt == NUMBER_OF_WEIGHT_WORDS-1) ? 1 : 0;
+
+		if (word_cnt < B_NUM_ROWS*B_NUM_COLS) write_output.data = resident_b_matrix[word_cnt];
+		else write_output.data = resident_c_matrix[word_cnt-(B_NUM_ROWS*B_NUM_COLS)];
+
+		M_AXIS.write(write_output);
+	}
+}
+
+
+ap_uint<8> saturate_weight(ap_int<48> weight) {
+	// Weights are unsigned Q<0.8>, clamp instead of wrapping around
+	return (weight < 0) ? (ap_uint<8>)0 : (weight > 255) ? (ap_uint<8>)255 : (ap_uint<8>)weight;
+}
+
+
+void myip_v1_0_HLS_train(hls::stream<AXIS_wLAST>& S_AXIS, hls::stream<AXIS_wLAST>& M_AXIS) {
+	ap_uint<8> train_a_matrix[A_NUM_ROWS*A_NUM_COLS];
+	ap_uint<1> train_labels[NUMBER_OF_LABEL_WORDS];
+
+	// Gradients accumulated over the whole batch, then applied once (batch SGD step)
+	// Worst case |error * c * x| summed over 64 datapoints is below 2^31, 48 bits leaves headroom
+	ap_int<48> grad_b[B_NUM_ROWS*B_NUM_COLS] = {0};
+	ap_int<48> grad_c[C_NUM_ROWS*C_NUM_COLS] = {0};
+	ap_uint<32> sum_abs_error = 0;
+
+	AXIS_wLAST write_output;
+
+	/**************************** RECEIVE DATAPOINTS, LABELS ************************************/
+	myip_v1_0_HLS_train_receive:for (int word_cnt = 0; word_cnt < A_NUM_ROWS*A_NUM_COLS + NUMBER_OF_LABEL_WORDS; word_cnt++) {
+		AXIS_wLAST read_input = S_AXIS.read();
+
+		if (word_cnt < A_NUM_ROWS*A_NUM_COLS) train_a_matrix[word_cnt] = read_input.data;
+		else train_labels[word_cnt-(A_NUM_ROWS*A_NUM_COLS)] = read_input.data;
+	}
+
+	/**************************** FORWARD, ERROR, BACKWARD ************************************/
+	// hidden_k = (x . b_k + b0_k) >> 8,  y = (hidden_1*c_1 + hidden_2*c_2 + c_0) >> 8
+	// With error e = target - y, the descent direction is
+	//   c_0: e      c_k: e*hidden_k      b0_k: e*c_k      b_jk: e*c_k*x_j
+	// (common 2^-8 / 2^-16 factors are folded into the learning rate shifts)
+	myip_v1_0_HLS_train_rows:for (int i = 0; i < A_NUM_ROWS; i++) {
+		ap_uint<32> sum_1 = 0;
+		ap_uint<32> sum_2 = 0;
+
+		for (int j = 0; j < A_NUM_COLS; j++) {
+			ap_uint<8> datapoint = train_a_matrix[(i*A_NUM_COLS) + (j)];
+			sum_1 += datapoint * resident_b_matrix[B_DISREGARD_BIAS_TERM + (j*NUM_NEURONS_HIDDEN_LAYER)];
+			sum_2 += datapoint * resident_b_matrix[B_DISREGARD_BIAS_TERM + B_OFFSET_FOR_SECOND_NEURON + (j*NUM_NEURONS_HIDDEN_LAYER)];
+		}
+		sum_1 += resident_b_matrix[HIDDEN_LAYER_FIRST_NEURON];
+		sum_2 += resident_b_matrix[HIDDEN_LAYER_SECOND_NEURON];
+
+		ap_uint<8> hidden_1 = sum_1 >> NUM_FRACTIONAL_BITS;
+		ap_uint<8> hidden_2 = sum_2 >> NUM_FRACTIONAL_BITS;
+
+		ap_uint<32> sum = hidden_1 * resident_c_matrix[C_DISREGARD_BIAS_TERM]
+						+ hidden_2 * resident_c_matrix[C_DISREGARD_BIAS_TERM + 1]
+						+ resident_c_matrix[0];
+		ap_uint<8> output = sum >> NUM_FRACTIONAL_BITS;
+
+		ap_int<10> target = train_labels[i] ? TRAIN_TARGET_POSITIVE : TRAIN_TARGET_NEGATIVE;
+		ap_int<10> error = target - (ap_int<10>)output;
+		sum_abs_error += (error < 0) ? (ap_int<10>)(-error) : error;
+
+		grad_c[0] += error;
+		grad_c[C_DISREGARD_BIAS_TERM] += error * hidden_1;
+		grad_c[C_DISREGARD_BIAS_TERM + 1] += error * hidden_2;
+
+		// Error propagated back through the (linear) output neuron
+		ap_int<20> delta_1 = error * resident_c_matrix[C_DISREGARD_BIAS_TERM];
+		ap_int<20> delta_2 = error * resident_c_matrix[C_DISREGARD_BIAS_TERM + 1];
+
+		grad_b[HIDDEN_LAYER_FIRST_NEURON] += delta_1;
+		grad_b[HIDDEN_LAYER_SECOND_NEURON] += delta_2;
+		for (int j = 0; j < A_NUM_COLS; j++) {
+			ap_uint<8> datapoint = train_a_matrix[(i*A_NUM_COLS) + (j)];
+			grad_b[B_DISREGARD_BIAS_TERM + (j*NUM_NEURONS_HIDDEN_LAYER)] += delta_1 * datapoint;
+			grad_b[B_DISREGARD_BIAS_TERM + B_OFFSET_FOR_SECOND_NEURON + (j*NUM_NEURONS_HIDDEN_LAYER)] += delta_2 * datapoint;
+		}
+	}
+
+	/**************************** UPDATE RESIDENT WEIGHTS ************************************/
+	myip_v1_0_HLS_train_update_b:for (int k = 0; k < B_NUM_ROWS*B_NUM_COLS; k++) {
+		resident_b_matrix[k] = saturate_weight((ap_int<48>)resident_b_matrix[k] + (grad_b[k] >> TRAIN_LR_SHIFT_HIDDEN));
+	}
+	myip_v1_0_HLS_train_update_c:for (int k = 0; k < C_NUM_ROWS*C_NUM_COLS; k++) {
+		resident_c_matrix[k] = saturate_weight((ap_int<48>)resident_c_matrix[k] + (grad_c[k] >> TRAIN_LR_SHIFT_OUTPUT));
+	}
+
+	/**************************** READ BACK ************************************/
+	myip_v1_0_HLS_transmit_weights(M_AXIS, false);
+
+	write_output.last = 1;
+	write_output.data = sum_abs_error;
+	M_AXIS.write(write_output);
+}
+#endif
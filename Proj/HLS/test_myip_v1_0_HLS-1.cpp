@@ -14,12 +14,51 @@ typedef ap_axis<32,0,0,0> AXIS_wLAST;
 #define VERIFICATION_FAIL 1
 #define VERIFICATION_PASS 0
 
+// Must match the coprocessor
+//#define CASCADE_MODE
+#define NUMBER_OF_CASCADE_WORDS 10		// 8 screen weights, then the uncertainty band
+#define CASCADE_STAGE_SCREEN 1
+#define CASCADE_STAGE_FULL 2
+#define CASCADE_STAGE_SHIFT 8
+
+// Must match the coprocessor
+//#define ONLINE_TRAINING
+#define OPCODE_INFER 0
+#define OPCODE_INFER_RESIDENT 1
+#define OPCODE_TRAIN 2
+#define OPCODE_READ_WEIGHTS 3
+#define NUMBER_OF_WEIGHT_WORDS 19
+#define TRAIN_TARGET_NEGATIVE 32
+#define TRAIN_TARGET_POSITIVE 64
+#define TRAIN_LR_SHIFT_OUTPUT 15
+#define TRAIN_LR_SHIFT_HIDDEN 22
+#define NUMBER_OF_TRAIN_STEPS 4
+
+// Must match the coprocessor
+//#define BIT_SERIAL_KERNEL
+#ifndef BIT_SERIAL_LANES
+#define BIT_SERIAL_LANES 2
+#endif
+
+// Area/throughput report of the kernel variant
+#define STRINGIFY_VALUE(x) #x
+#define STRINGIFY(x) STRINGIFY_VALUE(x)
+// Take 'Latency (cycles)', 'LUT', 'FF' and 'DSP' of myip_v1_0_HLS from csynth.rpt of each variant
+// e.g -DKERNEL_LATENCY_CYCLES=1234 -DKERNEL_LUT=5678 -DKERNEL_FF=4321 -DKERNEL_DSP=2, nothing is reported without them
+#ifdef BIT_SERIAL_KERNEL
+#define KERNEL_VARIANT "bit-serial, " STRINGIFY(BIT_SERIAL_LANES) " lanes"
+#else
+#define KERNEL_VARIANT "parallel"
+#endif
+
 /***************** Coprocessor function declaration *********************/
 void myip_v1_0_HLS(hls::stream<AXIS_wLAST>& S_AXIS, hls::stream<AXIS_wLAST>& M_AXIS);
 
 /***************** Testbench functions *********************/
 void set_expected_memory();
 int verify();
+void report_area_throughput();
+int test_online_training(hls::stream<AXIS_wLAST>& S_AXIS, hls::stream<AXIS_wLAST>& M_AXIS);
 
 /************************** Variable Definitions *****************************/
 int test_input_memory [NUMBER_OF_TEST_VECTORS*NUMBER_OF_INPUT_WORDS] = {0x2c,0x5a,0x00,0x00,0x18,0x51,0x16,
@@ -67,6 +106,20 @@ int test_result_expected_memory [NUMBER_OF_TEST_VECTORS*NUMBER_OF_OUTPUT_WORDS]
 0x51,0x2d,0x3e,0x34};
 int result_memory [NUMBER_OF_TEST_VECTORS*NUMBER_OF_OUTPUT_WORDS];
 
+#ifdef ONLINE_TRAINING
+// Proj/Dataset/labels.csv
+int train_label_memory [A_NUM_ROWS] = {0,1,1,1,0,0,1,1,1,0,0,0,1,1,1,0,
+1,0,1,0,0,1,1,0,1,1,1,1,0,0,0,0,
+0,0,1,1,0,1,0,1,0,1,0,0,1,1,1,1,
+1,0,0,1,1,0,1,0,0,1,0,0,1,0,1,0};
+#endif
+
+#ifdef CASCADE_MODE
+// Proj/Dataset/w_screen.csv, Proj/Dataset/screen_band.csv
+int cascade_input_memory [NUMBER_OF_TEST_VECTORS*NUMBER_OF_CASCADE_WORDS] = {90,19,11,26,5,22,9,40,
+50,62};
+#endif
+
 
 int main()
 {
@@ -74,11 +127,22 @@ int main()
 	hls::stream<AXIS_wLAST> S_AXIS;
 	hls::stream<AXIS_wLAST> M_AXIS;
 
+#ifdef CASCADE_MODE
+	// Outputs are tagged by stage, derive them from a software model instead
+	set_expected_memory();
+#endif
 
 	for (int test_case_cnt=0 ; test_case_cnt < NUMBER_OF_TEST_VECTORS ; test_case_cnt++) {
 		/************************ TRANSMIT DATA TO CO-PROCESSOR **************************/
 		printf("TX data, test case %d ... \r\n", test_case_cnt);
 
+#ifdef ONLINE_TRAINING
+		// Plain inference, which also makes B, C the resident weights
+		write_input.last = 0;
+		write_input.data = OPCODE_INFER;
+		S_AXIS.write(write_input);
+#endif
+
 		for (int word_cnt=0 ; word_cnt < NUMBER_OF_INPUT_WORDS ; word_cnt++) {
 			// S_AXIS_TLAST is asserted for the last word.
 			// Actually, doesn't matter since we are not making using of S_AXIS_TLAST.
@@ -88,6 +152,14 @@ int main()
 			S_AXIS.write(write_input); // Insert one word into the stream
 		}
 
+#ifdef CASCADE_MODE
+		for (int word_cnt=0 ; word_cnt < NUMBER_OF_CASCADE_WORDS ; word_cnt++) {
+			write_input.last = (word_cnt==NUMBER_OF_CASCADE_WORDS-1) ? 1 : 0;
+			write_input.data = cascade_input_memory[word_cnt+test_case_cnt*NUMBER_OF_CASCADE_WORDS];
+			S_AXIS.write(write_input);
+		}
+#endif
+
 		write_input.last = 0;
 
 		/************************ CALL OUR HLS-SYNTHESIZED CO-PROCESSOR **************************/
@@ -123,13 +195,59 @@ int main()
 	}
 	else {
 		printf("Verification success\n");
-		return VERIFICATION_PASS;
+		report_area_throughput();
 	}
+
+#ifdef ONLINE_TRAINING
+	if (test_online_training(S_AXIS, M_AXIS) != 1) {
+		printf("Online training verification failed\n");
+		return VERIFICATION_FAIL;
+	}
+	printf("Online training verification success\n");
+#endif
+
+	return VERIFICATION_PASS;
 }
 
 
 
 
+void set_expected_memory() {
+#ifdef CASCADE_MODE
+	// Software model of the cascade, same fixed-point arithmetic as the coprocessor
+	for (int test_case_cnt=0 ; test_case_cnt < NUMBER_OF_TEST_VECTORS ; test_case_cnt++) {
+		int* a = &test_input_memory[test_case_cnt*NUMBER_OF_INPUT_WORDS];
+		int* b = a + A_NUM_ROWS*A_NUM_COLS;
+		int* c = b + 8*2;
+		int* s = &cascade_input_memory[test_case_cnt*NUMBER_OF_CASCADE_WORDS];
+		int* band = s + 8;
+
+		for (int i = 0; i < A_NUM_ROWS; i++) {
+			int* row = &a[i*A_NUM_COLS];
+			unsigned score = s[0];
+			for (int j = 0; j < A_NUM_COLS; j++) score += row[j] * s[1+j];
+			score >>= 8;
+
+			int expected;
+			if (band[0] <= (int)score && (int)score <= band[1]) {
+				unsigned sum_1 = b[0], sum_2 = b[1];
+				for (int j = 0; j < A_NUM_COLS; j++) {
+					sum_1 += row[j] * b[2 + 2*j];
+					sum_2 += row[j] * b[3 + 2*j];
+				}
+				unsigned out = ((sum_1 >> 8) & 0xFF) * c[1] + ((sum_2 >> 8) & 0xFF) * c[2] + c[0];
+				expected = (CASCADE_STAGE_FULL << CASCADE_STAGE_SHIFT) | ((out >> 8) & 0xFF);
+			}
+			else {
+				expected = (CASCADE_STAGE_SCREEN << CASCADE_STAGE_SHIFT) | (score > 255 ? 255 : score);
+			}
+			test_result_expected_memory[i+test_case_cnt*NUMBER_OF_OUTPUT_WORDS] = expected;
+		}
+	}
+#endif
+}
+
+
 int verify() {
 	int success = 1;
 
@@ -139,3 +257,145 @@ int verify() {
 
 	return success;
 }
+
+
+void report_area_throughput() {
+	// Rows per cycle per LUT is what decides how many compute units fit next to the rest of the design
+	printf("Kernel variant: %s\n", KERNEL_VARIANT);
+
+#if defined(KERNEL_LATENCY_CYCLES) && defined(KERNEL_LUT) && defined(KERNEL_FF) && defined(KERNEL_DSP)
+	double rows_per_cycle = (double)A_NUM_ROWS / KERNEL_LATENCY_CYCLES;
+
+	printf("Rows per cycle: %f (%d rows in %d cycles)\n", rows_per_cycle, A_NUM_ROWS, KERNEL_LATENCY_CYCLES);
+	printf("Area: %d LUT, %d FF, %d DSP\n", KERNEL_LUT, KERNEL_FF, KERNEL_DSP);
+	printf("Rows per cycle per LUT: %e\n", rows_per_cycle / KERNEL_LUT);
+#else
+	printf("Area/throughput: not reported, pass -DKERNEL_LATENCY_CYCLES -DKERNEL_LUT -DKERNEL_FF -DKERNEL_DSP from csynth.rpt\n");
+#endif
+}
+
+
+#ifdef ONLINE_TRAINING
+static int reference_inference(int* a_row, int* b, int* c, int* hidden_1, int* hidden_2) {
+	unsigned sum_1 = b[0], sum_2 = b[1];
+	for (int j = 0; j < A_NUM_COLS; j++) {
+		sum_1 += a_row[j] * b[2 + 2*j];
+		sum_2 += a_row[j] * b[3 + 2*j];
+	}
+	*hidden_1 = (sum_1 >> 8) & 0xFF;
+	*hidden_2 = (sum_2 >> 8) & 0xFF;
+
+	return ((*hidden_1 * c[1] + *hidden_2 * c[2] + c[0]) >> 8) & 0xFF;
+}
+
+
+static int saturate_weight(long long weight) {
+	return (weight < 0) ? 0 : (weight > 255) ? 255 : (int)weight;
+}
+
+
+static void reference_train_step(int* a, int* weights, int* sum_abs_error) {
+	// Software model of OPCODE_TRAIN, weights holds B then C
+	int* b = weights;
+	int* c = weights + B_NUM_ROWS*2;
+	long long grad[NUMBER_OF_WEIGHT_WORDS] = {0};
+	long long* grad_b = grad;
+	long long* grad_c = grad + B_NUM_ROWS*2;
+
+	*sum_abs_error = 0;
+	for (int i = 0; i < A_NUM_ROWS; i++) {
+		int hidden_1, hidden_2;
+		int output = reference_inference(&a[i*A_NUM_COLS], b, c, &hidden_1, &hidden_2);
+		int error = (train_label_memory[i] ? TRAIN_TARGET_POSITIVE : TRAIN_TARGET_NEGATIVE) - output;
+		*sum_abs_error += (error < 0) ? -error : error;
+
+		grad_c[0] += error;
+		grad_c[1] += error * hidden_1;
+		grad_c[2] += error * hidden_2;
+		grad_b[0] += error * c[1];
+		grad_b[1] += error * c[2];
+		for (int j = 0; j < A_NUM_COLS; j++) {
+			grad_b[2 + 2*j] += (long long)error * c[1] * a[i*A_NUM_COLS + j];
+			grad_b[3 + 2*j] += (long long)error * c[2] * a[i*A_NUM_COLS + j];
+		}
+	}
+
+	for (int k = 0; k < B_NUM_ROWS*2; k++) b[k] = saturate_weight(b[k] + (grad_b[k] >> TRAIN_LR_SHIFT_HIDDEN));
+	for (int k = 0; k < 3; k++) c[k] = saturate_weight(c[k] + (grad_c[k] >> TRAIN_LR_SHIFT_OUTPUT));
+}
+
+
+static void transmit_words(hls::stream<AXIS_wLAST>& S_AXIS, int opcode, int* words, int num_words) {
+	AXIS_wLAST write_input;
+
+	write_input.last = (num_words == 0) ? 1 : 0;
+	write_input.data = opcode;
+	S_AXIS.write(write_input);
+
+	for (int word_cnt=0 ; word_cnt < num_words ; word_cnt++) {
+		write_input.last = (word_cnt==num_words-1) ? 1 : 0;
+		write_input.data = words[word_cnt];
+		S_AXIS.write(write_input);
+	}
+}
+
+
+static int receive_words(hls::stream<AXIS_wLAST>& M_AXIS, int* words) {
+	AXIS_wLAST read_output;
+	int word_cnt = 0;
+
+	do {
+		read_output = M_AXIS.read();
+		words[word_cnt++] = read_output.data;
+	} while (read_output.last == false);
+
+	return word_cnt;
+}
+
+
+int test_online_training(hls::stream<AXIS_wLAST>& S_AXIS, hls::stream<AXIS_wLAST>& M_AXIS) {
+	// Resident weights are the B, C of the last OPCODE_INFER, i.e. of the final test case
+	int* a = &test_input_memory[(NUMBER_OF_TEST_VECTORS-1)*NUMBER_OF_INPUT_WORDS];
+	int reference_weights[NUMBER_OF_WEIGHT_WORDS];
+	int train_input[A_NUM_ROWS*A_NUM_COLS + A_NUM_ROWS];
+	int rx_words[A_NUM_ROWS + NUMBER_OF_WEIGHT_WORDS + 1];
+	int success = 1;
+
+	for (int k = 0; k < NUMBER_OF_WEIGHT_WORDS; k++) reference_weights[k] = a[A_NUM_ROWS*A_NUM_COLS + k];
+	for (int k = 0; k < A_NUM_ROWS*A_NUM_COLS; k++) train_input[k] = a[k];
+	for (int k = 0; k < A_NUM_ROWS; k++) train_input[A_NUM_ROWS*A_NUM_COLS + k] = train_label_memory[k];
+
+	// A few SGD steps on the same batch, the error should go down
+	for (int step = 0; step < NUMBER_OF_TRAIN_STEPS; step++) {
+		int expected_error;
+		reference_train_step(a, reference_weights, &expected_error);
+
+		transmit_words(S_AXIS, OPCODE_TRAIN, train_input, A_NUM_ROWS*A_NUM_COLS + A_NUM_ROWS);
+		myip_v1_0_HLS(S_AXIS, M_AXIS);
+		int num_words = receive_words(M_AXIS, rx_words);
+
+		success = success & (num_words == NUMBER_OF_WEIGHT_WORDS + 1);
+		for (int k = 0; k < NUMBER_OF_WEIGHT_WORDS; k++) success = success & (rx_words[k] == reference_weights[k]);
+		success = success & (rx_words[NUMBER_OF_WEIGHT_WORDS] == expected_error);
+
+		printf("Train step %d: sum |error| %d\n", step, rx_words[NUMBER_OF_WEIGHT_WORDS]);
+	}
+
+	// Weights read back must be the trained ones
+	transmit_words(S_AXIS, OPCODE_READ_WEIGHTS, NULL, 0);
+	myip_v1_0_HLS(S_AXIS, M_AXIS);
+	success = success & (receive_words(M_AXIS, rx_words) == NUMBER_OF_WEIGHT_WORDS);
+	for (int k = 0; k < NUMBER_OF_WEIGHT_WORDS; k++) success = success & (rx_words[k] == reference_weights[k]);
+
+	// Inference without resending B, C uses the trained weights
+	transmit_words(S_AXIS, OPCODE_INFER_RESIDENT, a, A_NUM_ROWS*A_NUM_COLS);
+	myip_v1_0_HLS(S_AXIS, M_AXIS);
+	success = success & (receive_words(M_AXIS, rx_words) == NUMBER_OF_OUTPUT_WORDS);
+	for (int i = 0; i < A_NUM_ROWS; i++) {
+		int hidden_1, hidden_2;
+		success = success & (rx_words[i] == reference_inference(&a[i*A_NUM_COLS], reference_weights, reference_weights + B_NUM_ROWS*2, &hidden_1, &hidden_2));
+	}
+
+	return success;
+}
+#endif
@@ -1,10 +1,33 @@
 #include "axi_dma.h"
+#include "trace.h"
+
+#ifdef AXI_DMA_INTERRUPT_MODE
+// Pipeline state, shared between dma_pipeline_start and the ISRs
+static volatile int pipeline_num_batches = 0;
+static volatile int mm2s_next_batch = 0;       // Next batch to send
+static volatile int s2mm_done_batches = 0;     // Also the batch S2MM is armed for
+static volatile int pipeline_error = 0;
+#endif
+
+#ifdef AXI_DMA_SG_MODE
+// BD space of each ring, the DMA walks these on its own
+static XAxiDma_Bd dma_tx_bd_space[DMA_SG_NUM_BDS] __attribute__ ((aligned (XAXIDMA_BD_MINIMUM_ALIGNMENT)));
+static XAxiDma_Bd dma_rx_bd_space[DMA_SG_NUM_BDS] __attribute__ ((aligned (XAXIDMA_BD_MINIMUM_ALIGNMENT)));
+#endif
 
 int s2mm_transmit(XAxiDma* AxiDma, int test_case_cnt) {
+    if (s2mm_start(AxiDma, test_case_cnt) != XST_SUCCESS) return XST_FAILURE;
+    return s2mm_finish(AxiDma, test_case_cnt);
+}
+
+int s2mm_start(XAxiDma* AxiDma, int test_case_cnt) {
+    // Arms S2MM for the results of batch 'test_case_cnt', without waiting for them
+    int* results = HARD_result_memory + test_case_cnt*NUMBER_OF_OUTPUT_WORDS;
+    dma_invalidate(results, NUMBER_OF_OUTPUT_WORDS*WORD_SIZE_IN_BYTES);
+
     // Tell DMA to do a transfer (note since Stream is source, we need not specify source address)
     // NOTE: Length of transfer is in bytes
-    int Status = XAxiDma_SimpleTransfer(AxiDma, (u32)(HARD_result_memory + test_case_cnt*NUMBER_OF_OUTPUT_WORDS), 
-                        NUMBER_OF_OUTPUT_WORDS*WORD_SIZE_IN_BYTES, XAXIDMA_DEVICE_TO_DMA);
+    int Status = XAxiDma_SimpleTransfer(AxiDma, (UINTPTR)results, NUMBER_OF_OUTPUT_WORDS*WORD_SIZE_IN_BYTES, XAXIDMA_DEVICE_TO_DMA);
     if (Status != XST_SUCCESS) return XST_FAILURE;
 
     // Check receive channel, it should be running after SimpleTransfer()
@@ -14,6 +37,12 @@ int s2mm_transmit(XAxiDma* AxiDma, int test_case_cnt) {
 						XAXIDMA_CR_OFFSET);
     xil_printf("%0d\n", register_value & XAXIDMA_CR_RUNSTOP_MASK);
     */
+    return XST_SUCCESS;
+}
+
+int s2mm_finish(XAxiDma* AxiDma, int test_case_cnt) {
+    // Returns once the results of batch 'test_case_cnt' are in, S2MM must have been armed for it
+    int* results = HARD_result_memory + test_case_cnt*NUMBER_OF_OUTPUT_WORDS;
 
     // Polling check of DMA's S2MM_DMASR register's Idle flag, but they invert the result
     while (XAxiDma_Busy(AxiDma,XAXIDMA_DEVICE_TO_DMA)) {
@@ -32,7 +61,7 @@ int s2mm_transmit(XAxiDma* AxiDma, int test_case_cnt) {
 
     // INVALIDATE the destCache (Main Memory) after receiving the data, so that 
     // PS is forced to read from Main Memory (not cache), which is exactly where Coprocessor wrote to
-    Xil_DCacheInvalidateRange((u32)(HARD_result_memory+test_case_cnt*NUMBER_OF_OUTPUT_WORDS), NUMBER_OF_OUTPUT_WORDS);
+    dma_invalidate(results, NUMBER_OF_OUTPUT_WORDS*WORD_SIZE_IN_BYTES);
 
     return XST_SUCCESS;
 }
@@ -61,14 +90,19 @@ int mm2s_transmit(XAxiDma* AxiDma, int test_case_cnt) {
     */
     // xil_printf("%p\n", (void*)HARD_result_memory);
 
-    // FLUSH the srcCache (Main Memory) and destCache (Coprocessor) before the DMA transfer, so main memory has most recent data
-    Xil_DCacheFlushRange((u32)(HARD_result_memory+test_case_cnt*NUMBER_OF_INPUT_WORDS), NUMBER_OF_INPUT_WORDS*WORD_SIZE_IN_BYTES);
-    Xil_DCacheFlushRange((u32)(HARD_input_memory+test_case_cnt*NUMBER_OF_INPUT_WORDS), NUMBER_OF_INPUT_WORDS*WORD_SIZE_IN_BYTES);
+    return mm2s_transmit_words(AxiDma, HARD_input_memory + test_case_cnt*NUMBER_OF_INPUT_WORDS, NUMBER_OF_INPUT_WORDS);
+}
+
+int mm2s_transmit_words(XAxiDma* AxiDma, void* words, int num_words) {
+    // Any run of words, e.g an opcode word, then part of a batch (MODEL_REGISTRY)
+    // The coprocessor only counts words, so a batch may come in several transfers
+
+    // FLUSH the words before the DMA transfer, so main memory has most recent data
+    dma_flush(words, num_words*WORD_SIZE_IN_BYTES);
 
     // Tell DMA to do a transfer (note since Stream is destination, we need not specify destination address)
     // NOTE: Length of transfer is in bytes
-    int Status = XAxiDma_SimpleTransfer(AxiDma, (u32)(HARD_input_memory + test_case_cnt*NUMBER_OF_INPUT_WORDS), 
-                        NUMBER_OF_INPUT_WORDS*WORD_SIZE_IN_BYTES, XAXIDMA_DMA_TO_DEVICE);
+    int Status = XAxiDma_SimpleTransfer(AxiDma, (UINTPTR)words, num_words*WORD_SIZE_IN_BYTES, XAXIDMA_DMA_TO_DEVICE);
     if (Status != XST_SUCCESS) return XST_FAILURE;
 
     // Polling check of DMA's MM2S_DMASR register's Idle flag, but they invert the result
@@ -105,11 +139,18 @@ int init_DMA_system(u16 DeviceId, XAxiDma* AxiDma) {
 		return XST_FAILURE;
 	}
 
+#ifdef AXI_DMA_SG_MODE
+    if (!XAxiDma_HasSg(AxiDma)) {
+        xil_printf("DMA not configured for Scatter-Gather\r\n");
+        return XST_FAILURE;
+    }
+#else
     // We should be running DMA in DIRECT REGISTER mode (ie. the simplest mode)
 	if (XAxiDma_HasSg(AxiDma)) {
 		xil_printf("DMA configured for Scatter-Gather\r\n");
 		return XST_FAILURE;
 	}
+#endif
 
     // Disable DMA Interrupts
     XAxiDma_IntrDisable(AxiDma, XAXIDMA_IRQ_ALL_MASK,
@@ -117,8 +158,265 @@ int init_DMA_system(u16 DeviceId, XAxiDma* AxiDma) {
     XAxiDma_IntrDisable(AxiDma, XAXIDMA_IRQ_ALL_MASK,
                 XAXIDMA_DMA_TO_DEVICE);
 
+#ifdef AXI_DMA_INTERRUPT_MODE
+    // Completion and error interrupts only, delay interrupt is for coalescing in SG mode
+    XAxiDma_IntrEnable(AxiDma, XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK,
+                XAXIDMA_DEVICE_TO_DMA);
+    XAxiDma_IntrEnable(AxiDma, XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_ERROR_MASK,
+                XAXIDMA_DMA_TO_DEVICE);
+#endif
+
     // For debugging purposes, we might need to disable caches
     //Xil_DCacheDisable();
 
+#ifdef AXI_DMA_SG_MODE
+    return init_DMA_sg_rings(AxiDma);
+#else
+    return XST_SUCCESS;
+#endif
+}
+
+
+#ifdef AXI_DMA_SG_MODE
+/*********************************** Scatter-Gather *********************************************/
+static int setup_bd(XAxiDma_BdRing* Ring, XAxiDma_Bd* BdPtr, int* buffer, u32 num_bytes, u32 ctrl) {
+    if (XAxiDma_BdSetBufAddr(BdPtr, (UINTPTR)buffer) != XST_SUCCESS) return XST_FAILURE;
+    if (XAxiDma_BdSetLength(BdPtr, num_bytes, Ring->MaxTransferLen) != XST_SUCCESS) return XST_FAILURE;
+    XAxiDma_BdSetCtrl(BdPtr, ctrl);
+
+    // Id remembers which batch buffer the BD points at, so a BD which already does is not rewritten
+    XAxiDma_BdSetId(BdPtr, (UINTPTR)buffer);
+
+    return XST_SUCCESS;
+}
+
+
+static int submit_ring(XAxiDma_BdRing* Ring, int* memory, int words_per_batch, u32 ctrl, int num_batches) {
+    XAxiDma_Bd* BdSetPtr;
+    XAxiDma_Bd* BdPtr;
+
+    if (XAxiDma_BdRingAlloc(Ring, num_batches, &BdSetPtr) != XST_SUCCESS) return XST_FAILURE;
+
+    // BDs were prebuilt by init_DMA_sg_rings, only fix up the ones that point at another batch
+    // (happens when fewer than DMA_SG_NUM_BDS batches were submitted last time)
+    BdPtr = BdSetPtr;
+    for (int batch = 0; batch < num_batches; batch++) {
+        int* buffer = memory + batch*words_per_batch;
+
+        if (XAxiDma_BdGetId(BdPtr) != (UINTPTR)buffer) {
+            if (setup_bd(Ring, BdPtr, buffer, words_per_batch*WORD_SIZE_IN_BYTES, ctrl) != XST_SUCCESS) return XST_FAILURE;
+        }
+        BdPtr = (XAxiDma_Bd*)XAxiDma_BdRingNext(Ring, BdPtr);
+    }
+
+    // Hand the whole chain to the DMA, a single tail pointer update
+    return XAxiDma_BdRingToHw(Ring, num_batches, BdSetPtr);
+}
+
+
+static int reap_ring(XAxiDma_BdRing* Ring, int num_batches) {
+    XAxiDma_Bd* BdSetPtr;
+    XAxiDma_Bd* BdPtr;
+    int num_reaped = 0;
+    int timeout = DMA_SG_TIMEOUT;
+
+    while (num_reaped < num_batches) {
+        int num_bds = XAxiDma_BdRingFromHw(Ring, XAXIDMA_ALL_BDS, &BdSetPtr);
+
+        if (num_bds == 0) {
+            if (--timeout == 0) return XST_FAILURE;
+            continue;
+        }
+
+        BdPtr = BdSetPtr;
+        for (int k = 0; k < num_bds; k++) {
+            if (XAxiDma_BdGetSts(BdPtr) & XAXIDMA_BD_STS_ALL_ERR_MASK) return XST_FAILURE;
+            BdPtr = (XAxiDma_Bd*)XAxiDma_BdRingNext(Ring, BdPtr);
+        }
+
+        if (XAxiDma_BdRingFree(Ring, num_bds, BdSetPtr) != XST_SUCCESS) return XST_FAILURE;
+        num_reaped += num_bds;
+    }
+
+    return XST_SUCCESS;
+}
+
+
+int init_DMA_sg_rings(XAxiDma* AxiDma) {
+    XAxiDma_BdRing* TxRing = XAxiDma_GetTxRing(AxiDma);
+    XAxiDma_BdRing* RxRing = XAxiDma_GetRxRing(AxiDma);
+    XAxiDma_Bd BdTemplate;
+    XAxiDma_Bd* BdSetPtr;
+    XAxiDma_Bd* BdPtr;
+
+    if (XAxiDma_BdRingCreate(TxRing, (UINTPTR)dma_tx_bd_space, (UINTPTR)dma_tx_bd_space,
+                             XAXIDMA_BD_MINIMUM_ALIGNMENT, DMA_SG_NUM_BDS) != XST_SUCCESS) return XST_FAILURE;
+    if (XAxiDma_BdRingCreate(RxRing, (UINTPTR)dma_rx_bd_space, (UINTPTR)dma_rx_bd_space,
+                             XAXIDMA_BD_MINIMUM_ALIGNMENT, DMA_SG_NUM_BDS) != XST_SUCCESS) return XST_FAILURE;
+
+    XAxiDma_BdClear(&BdTemplate);
+    if (XAxiDma_BdRingClone(TxRing, &BdTemplate) != XST_SUCCESS) return XST_FAILURE;
+    if (XAxiDma_BdRingClone(RxRing, &BdTemplate) != XST_SUCCESS) return XST_FAILURE;
+
+    // Prebuild every BD once: batch k of HARD_input_memory / HARD_result_memory
+    // Each MM2S batch is a whole packet (SOF+EOF), the coprocessor ends each S2MM batch with TLAST
+    if (XAxiDma_BdRingAlloc(TxRing, DMA_SG_NUM_BDS, &BdSetPtr) != XST_SUCCESS) return XST_FAILURE;
+    BdPtr = BdSetPtr;
+    for (int batch = 0; batch < DMA_SG_NUM_BDS; batch++) {
+        if (setup_bd(TxRing, BdPtr, HARD_input_memory + batch*NUMBER_OF_INPUT_WORDS, NUMBER_OF_INPUT_WORDS*WORD_SIZE_IN_BYTES,
+                     XAXIDMA_BD_CTRL_TXSOF_MASK | XAXIDMA_BD_CTRL_TXEOF_MASK) != XST_SUCCESS) return XST_FAILURE;
+        BdPtr = (XAxiDma_Bd*)XAxiDma_BdRingNext(TxRing, BdPtr);
+    }
+    // Give them back untouched, submit_ring allocates them again in the same order
+    if (XAxiDma_BdRingUnAlloc(TxRing, DMA_SG_NUM_BDS, BdSetPtr) != XST_SUCCESS) return XST_FAILURE;
+
+    if (XAxiDma_BdRingAlloc(RxRing, DMA_SG_NUM_BDS, &BdSetPtr) != XST_SUCCESS) return XST_FAILURE;
+    BdPtr = BdSetPtr;
+    for (int batch = 0; batch < DMA_SG_NUM_BDS; batch++) {
+        if (setup_bd(RxRing, BdPtr, HARD_result_memory + batch*NUMBER_OF_OUTPUT_WORDS, NUMBER_OF_OUTPUT_WORDS*WORD_SIZE_IN_BYTES,
+                     0) != XST_SUCCESS) return XST_FAILURE;
+        BdPtr = (XAxiDma_Bd*)XAxiDma_BdRingNext(RxRing, BdPtr);
+    }
+    if (XAxiDma_BdRingUnAlloc(RxRing, DMA_SG_NUM_BDS, BdSetPtr) != XST_SUCCESS) return XST_FAILURE;
+
+    // Polled completions, no interrupts
+    XAxiDma_BdRingIntDisable(TxRing, XAXIDMA_IRQ_ALL_MASK);
+    XAxiDma_BdRingIntDisable(RxRing, XAXIDMA_IRQ_ALL_MASK);
+
+    if (XAxiDma_BdRingStart(TxRing) != XST_SUCCESS) return XST_FAILURE;
+    if (XAxiDma_BdRingStart(RxRing) != XST_SUCCESS) return XST_FAILURE;
+
+    return XST_SUCCESS;
+}
+
+
+int sg_transmit(XAxiDma* AxiDma, int num_batches) {
+    XAxiDma_BdRing* TxRing = XAxiDma_GetTxRing(AxiDma);
+    XAxiDma_BdRing* RxRing = XAxiDma_GetRxRing(AxiDma);
+
+    if (num_batches == 0) return XST_SUCCESS;
+
+    // FLUSH all input batches, so main memory has most recent data for MM2S
+    // INVALIDATE the results too, no dirty line may be evicted over what S2MM writes
+    dma_flush(HARD_input_memory, num_batches*NUMBER_OF_INPUT_WORDS*WORD_SIZE_IN_BYTES);
+    dma_invalidate(HARD_result_memory, num_batches*NUMBER_OF_OUTPUT_WORDS*WORD_SIZE_IN_BYTES);
+
+    // S2MM first, so no result has to wait for a BD
+    if (submit_ring(RxRing, HARD_result_memory, NUMBER_OF_OUTPUT_WORDS, 0, num_batches) != XST_SUCCESS) {
+        xil_printf("s2mm BD submit error\n");
+        return XST_FAILURE;
+    }
+    if (submit_ring(TxRing, HARD_input_memory, NUMBER_OF_INPUT_WORDS,
+                    XAXIDMA_BD_CTRL_TXSOF_MASK | XAXIDMA_BD_CTRL_TXEOF_MASK, num_batches) != XST_SUCCESS) {
+        xil_printf("mm2s BD submit error\n");
+        return XST_FAILURE;
+    }
+
+    // DMA chains the batches back-to-back, PS only reaps at the end
+    if (reap_ring(TxRing, num_batches) != XST_SUCCESS) {
+        xil_printf("mm2s BD error\n");
+        return XST_FAILURE;
+    }
+    if (reap_ring(RxRing, num_batches) != XST_SUCCESS) {
+        xil_printf("s2mm BD error\n");
+        return XST_FAILURE;
+    }
+
+    // INVALIDATE the results, PS must read what the Coprocessor wrote to main memory
+    dma_invalidate(HARD_result_memory, num_batches*NUMBER_OF_OUTPUT_WORDS*WORD_SIZE_IN_BYTES);
+
     return XST_SUCCESS;
-}
\ No newline at end of file
+}
+#endif
+
+
+#ifdef AXI_DMA_INTERRUPT_MODE
+/*********************************** Interrupt pipeline *********************************************/
+static int start_mm2s(XAxiDma* AxiDma) {
+    // Throttled, so the Coprocessor never runs too far ahead of the results being collected
+    if (mm2s_next_batch >= pipeline_num_batches) return XST_SUCCESS;
+    if (mm2s_next_batch - s2mm_done_batches >= DMA_PIPELINE_DEPTH) return XST_SUCCESS;
+    if (XAxiDma_Busy(AxiDma, XAXIDMA_DMA_TO_DEVICE)) return XST_SUCCESS;
+
+    int batch = mm2s_next_batch++;
+    return XAxiDma_SimpleTransfer(AxiDma, (UINTPTR)(HARD_input_memory + batch*NUMBER_OF_INPUT_WORDS),
+                        NUMBER_OF_INPUT_WORDS*WORD_SIZE_IN_BYTES, XAXIDMA_DMA_TO_DEVICE);
+}
+
+
+static int arm_s2mm(XAxiDma* AxiDma) {
+    if (s2mm_done_batches >= pipeline_num_batches) return XST_SUCCESS;
+
+    int* results = HARD_result_memory + s2mm_done_batches*NUMBER_OF_OUTPUT_WORDS;
+    dma_invalidate(results, NUMBER_OF_OUTPUT_WORDS*WORD_SIZE_IN_BYTES);
+    return XAxiDma_SimpleTransfer(AxiDma, (UINTPTR)results, NUMBER_OF_OUTPUT_WORDS*WORD_SIZE_IN_BYTES, XAXIDMA_DEVICE_TO_DMA);
+}
+
+
+void dma_mm2s_interrupt_handler(XAxiDma* AxiDma) {
+    u32 IrqStatus = XAxiDma_IntrGetIrq(AxiDma, XAXIDMA_DMA_TO_DEVICE);
+    XAxiDma_IntrAckIrq(AxiDma, IrqStatus, XAXIDMA_DMA_TO_DEVICE);
+    TRACE_INFO(TRACE_DMA_MM2S_IRQ, mm2s_next_batch, 0, 0);
+
+    if (IrqStatus & XAXIDMA_IRQ_ERROR_MASK) {
+        TRACE_ERROR(TRACE_DMA_ERROR, 0, IrqStatus, 0);
+        pipeline_error = 1;
+        return;
+    }
+
+    // Channel is free again, send the next batch while the Coprocessor works on this one
+    if (IrqStatus & XAXIDMA_IRQ_IOC_MASK) {
+        if (start_mm2s(AxiDma) != XST_SUCCESS) pipeline_error = 1;
+    }
+}
+
+
+void dma_s2mm_interrupt_handler(XAxiDma* AxiDma) {
+    u32 IrqStatus = XAxiDma_IntrGetIrq(AxiDma, XAXIDMA_DEVICE_TO_DMA);
+    XAxiDma_IntrAckIrq(AxiDma, IrqStatus, XAXIDMA_DEVICE_TO_DMA);
+    TRACE_INFO(TRACE_DMA_S2MM_IRQ, s2mm_done_batches, 0, 0);
+
+    if (IrqStatus & XAXIDMA_IRQ_ERROR_MASK) {
+        TRACE_ERROR(TRACE_DMA_ERROR, 1, IrqStatus, 0);
+        pipeline_error = 1;
+        return;
+    }
+
+    if (IrqStatus & XAXIDMA_IRQ_IOC_MASK) {
+        // INVALIDATE the batch just written by the Coprocessor
+        dma_invalidate(HARD_result_memory + s2mm_done_batches*NUMBER_OF_OUTPUT_WORDS, NUMBER_OF_OUTPUT_WORDS*WORD_SIZE_IN_BYTES);
+        s2mm_done_batches++;
+
+        // Re-arm for the next batch first, then MM2S may have been waiting on the pipeline depth
+        if (arm_s2mm(AxiDma) != XST_SUCCESS) pipeline_error = 1;
+        if (start_mm2s(AxiDma) != XST_SUCCESS) pipeline_error = 1;
+    }
+}
+
+
+int dma_pipeline_start(XAxiDma* AxiDma, int num_batches) {
+    pipeline_num_batches = num_batches;
+    mm2s_next_batch = 0;
+    s2mm_done_batches = 0;
+    pipeline_error = 0;
+
+    if (num_batches == 0) return XST_SUCCESS;
+
+    // FLUSH every input batch up front, the ISRs then only need to kick the DMA
+    dma_flush(HARD_input_memory, num_batches*NUMBER_OF_INPUT_WORDS*WORD_SIZE_IN_BYTES);
+
+    // S2MM before MM2S, so the Coprocessor's output never stalls on an unarmed channel
+    if (arm_s2mm(AxiDma) != XST_SUCCESS) return XST_FAILURE;
+    return start_mm2s(AxiDma);
+}
+
+
+int dma_pipeline_done() {
+    return pipeline_error || (s2mm_done_batches == pipeline_num_batches);
+}
+
+
+int dma_pipeline_status() {
+    return pipeline_error ? XST_FAILURE : XST_SUCCESS;
+}
+#endif
\ No newline at end of file
@@ -4,14 +4,41 @@
 #endif
 
 #include "xaxidma.h"
-#include "xil_cache.h"
+#include "dma_arena.h"
 
+// Scatter-gather mode: MM2S/S2MM buffer descriptor rings cover all batches, which are submitted in one go
+// Needs the AXI DMA built with 'Enable Scatter Gather Engine'
+//#define AXI_DMA_SG_MODE
+// Interrupt mode: S2MM is armed before MM2S, batches are pipelined and completions are handled in the ISRs
+// Needs mm2s_introut, s2mm_introut of the AXI DMA connected to pl_ps_irq0
+//#define AXI_DMA_INTERRUPT_MODE
 #define DMA_DEV_ID  XPAR_AXIDMA_0_DEVICE_ID    // AXI_DMA_0 peripheral
+#define DMA_SG_NUM_BDS NUMBER_OF_TEST_VECTORS  // One BD per batch and direction
+#define DMA_SG_TIMEOUT (1<<20)                  // Empty polls of a ring before giving up
+#define DMA_PIPELINE_DEPTH 2                    // Batches sent (MM2S) but not yet received (S2MM)
+
+#if defined(AXI_DMA_SG_MODE) && defined(AXI_DMA_INTERRUPT_MODE)
+    #error "Choose one of AXI_DMA_SG_MODE, AXI_DMA_INTERRUPT_MODE"
+#endif
 
 extern int test_case_cnt;
-extern int HARD_input_memory [NUMBER_OF_TEST_VECTORS*NUMBER_OF_INPUT_WORDS];
-extern int HARD_result_memory [NUMBER_OF_TEST_VECTORS*NUMBER_OF_OUTPUT_WORDS];
+#if (NUMBER_OF_OUTPUT_WORDS*WORD_SIZE_IN_BYTES) % CACHE_LINE_SIZE != 0
+    #error "Results of a batch are invalidated on their own, they must fill whole cache lines"
+#endif
+
+extern int* HARD_input_memory;
+extern int* HARD_result_memory;
 
 int init_DMA_system(u16 DeviceId, XAxiDma* AxiDma);
 int mm2s_transmit(XAxiDma* AxiDma, int test_case_cnt);
-int s2mm_transmit(XAxiDma* AxiDma, int test_case_cnt);
\ No newline at end of file
+int mm2s_transmit_words(XAxiDma* AxiDma, void* words, int num_words);
+int s2mm_transmit(XAxiDma* AxiDma, int test_case_cnt);
+int s2mm_start(XAxiDma* AxiDma, int test_case_cnt);
+int s2mm_finish(XAxiDma* AxiDma, int test_case_cnt);
+int init_DMA_sg_rings(XAxiDma* AxiDma);
+int sg_transmit(XAxiDma* AxiDma, int num_batches);
+void dma_mm2s_interrupt_handler(XAxiDma* AxiDma);
+void dma_s2mm_interrupt_handler(XAxiDma* AxiDma);
+int dma_pipeline_start(XAxiDma* AxiDma, int num_batches);
+int dma_pipeline_done();
+int dma_pipeline_status();
\ No newline at end of file
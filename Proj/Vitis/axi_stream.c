@@ -28,4 +28,46 @@ int init_base_FIFO_system(u16 FIFODeviceId, XLlFifo* FifoInstancePtr) {
 	}
 
 	return XST_SUCCESS;
+}
+
+/*********************************** RX descriptor ring *********************************************/
+// Single producer (ISR), single consumer (bottom half): head is only written by the ISR, tail only by the consumer
+static axis_rx_descriptor rx_ring[AXIS_RX_RING_SIZE];
+static volatile u32 rx_ring_head = 0;
+static volatile u32 rx_ring_tail = 0;
+static volatile u32 rx_ring_overflows = 0;
+
+void axis_rx_ring_push(int batch, u32 irq_time) {
+    u32 head = rx_ring_head;
+
+    // Dropping a descriptor loses no data, the bottom half drains the whole FIFO's RX for any descriptor it pops
+    if (head - rx_ring_tail == AXIS_RX_RING_SIZE) {
+        rx_ring_overflows++;
+        return;
+    }
+
+    rx_ring[head & (AXIS_RX_RING_SIZE-1)].batch = batch;
+    rx_ring[head & (AXIS_RX_RING_SIZE-1)].irq_time = irq_time;
+
+    // Publish after the data, single core so volatile ordering is enough
+    rx_ring_head = head + 1;
+}
+
+int axis_rx_ring_pop(axis_rx_descriptor* descriptor) {
+    u32 tail = rx_ring_tail;
+
+    if (tail == rx_ring_head) return 0;
+
+    *descriptor = rx_ring[tail & (AXIS_RX_RING_SIZE-1)];
+    rx_ring_tail = tail + 1;
+
+    return 1;
+}
+
+int axis_rx_ring_empty() {
+    return rx_ring_tail == rx_ring_head;
+}
+
+u32 axis_rx_ring_overflows() {
+    return rx_ring_overflows;
 }
\ No newline at end of file
@@ -5,8 +5,32 @@
 
 #include "xstreamer.h"
 #include "xllfifo.h"
+#include "xpseudo_asm.h"
 
 //#define AXI_STREAM_POLLING_MODE
 #define FIFO_DEV_ID             XPAR_AXI_FIFO_0_DEVICE_ID      // AXI_FIFO_MM_S_0 peripheral
+#ifndef AXIS_TX_CHUNK_WORDS
+    #define AXIS_TX_CHUNK_WORDS 256     // Largest XLlFifo_Write, the TX vacancy at the time caps it further
+#endif
+#ifdef XPAR_AXI_FIFO_0_TX_FIFO_DEPTH
+    #define AXIS_TX_FIFO_DEPTH  XPAR_AXI_FIFO_0_TX_FIFO_DEPTH
+#else
+    #define AXIS_TX_FIFO_DEPTH  1024    // C_TX_FIFO_DEPTH of AXI_FIFO_MM_S_0 in wrapper.xsa
+#endif
+// A batch goes out as one packet and the FIFO is store-and-forward, so the whole packet (plus the MODEL_REGISTRY opcode word) must fit
+#if NUMBER_OF_INPUT_WORDS + 1 > AXIS_TX_FIFO_DEPTH
+    #error "A batch does not fit the AXI-Stream FIFO's TX, raise C_TX_FIFO_DEPTH in the block diagram"
+#endif
+#define AXIS_RX_RING_SIZE       16      // Packet descriptors in flight between the ISR and the bottom half, power of 2
+
+// What the ISR hands to the bottom half, the packet data itself stays in the FIFO's RX until it is copied out
+typedef struct {
+    int batch;                  // Batch being sent when RC was raised. Packets come back in order, the bottom half places them by count
+    u32 irq_time;               // Timer value in the ISR, for the delay until the copy out
+} axis_rx_descriptor;
 
-int init_base_FIFO_system(u16 FIFODeviceId, XLlFifo* FifoInstancePtr);
\ No newline at end of file
+int init_base_FIFO_system(u16 FIFODeviceId, XLlFifo* FifoInstancePtr);
+void axis_rx_ring_push(int batch, u32 irq_time);
+int axis_rx_ring_pop(axis_rx_descriptor* descriptor);
+int axis_rx_ring_empty();
+u32 axis_rx_ring_overflows();
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include "backend.h"
+#include "trace.h"
+
+const infer_backend* backend_find(const infer_backend* backends, int num_backends, char command) {
+    for (int backend = 0; backend < num_backends; backend++) {
+        if (backends[backend].command == command) return &backends[backend];
+    }
+    return NULL;
+}
+
+int backend_switch(const infer_backend** active, const infer_backend* next) {
+    // Old transport goes quiet first, both may share the coprocessor
+    if (*active != NULL && (*active)->teardown() != XST_SUCCESS) {
+        xil_printf("%s teardown failed\n", (*active)->name);
+        return XST_FAILURE;
+    }
+    *active = NULL;
+
+    if (next->init() != XST_SUCCESS) {
+        xil_printf("%s initialization failed\n", next->name);
+        return XST_FAILURE;
+    }
+    *active = next;
+    TRACE_INFO(TRACE_BACKEND_SWITCH, next->command, 0, 0);
+
+    return XST_SUCCESS;
+}
+
+void backend_print_commands(const infer_backend* backends, int num_backends) {
+    xil_printf("Backends:");
+    for (int backend = 0; backend < num_backends; backend++) {
+        xil_printf(" (%c) %s", backends[backend].command, backends[backend].name);
+    }
+    xil_printf(", (%c) quit\n", BACKEND_QUIT);
+}
\ No newline at end of file
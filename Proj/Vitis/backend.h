@@ -0,0 +1,30 @@
+#ifndef COMMON_HEADER
+    #define COMMON_HEADER
+    #include "common.h"
+#endif
+
+// Every transport to the coprocessor (and SOFT) in one image, switched at runtime by a command character over the UART
+// After the normal run, the board reads commands: each selects a backend (teardown of the old one, init of the new one),
+// then runs the workload through it and reports its cycles and mismatches against SOFT ('q' ends the session)
+// Needs the bitstream with both the AXI-Stream FIFO and the AXI DMA, and their interrupts connected to pl_ps_irq0
+// Without it, the build only has the backend chosen in main.h / axi_stream.h and HARD_processing still goes through it
+//#define RUNTIME_BACKENDS
+
+#define BACKEND_SOFT        's'
+#define BACKEND_FIFO_POLL   'p'
+#define BACKEND_FIFO_IRQ    'i'
+#define BACKEND_DMA         'd'
+#define BACKEND_QUIT        'q'
+
+typedef struct {
+    const char* name;
+    char command;               // UART command character selecting it
+    int (*init)();              // Brings the transport up, XST_SUCCESS/XST_FAILURE
+    int (*submit)(int batch);   // Hands batch 'batch' of the ingest buffer over
+    int (*wait)(int batch);     // Returns once its results are in HARD_result_memory
+    int (*teardown)();          // Leaves the transport quiet, another backend may be initialized next
+} infer_backend;
+
+const infer_backend* backend_find(const infer_backend* backends, int num_backends, char command);
+int backend_switch(const infer_backend** active, const infer_backend* next);
+void backend_print_commands(const infer_backend* backends, int num_backends);
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "bench.h"
+
+static u32 cycles_to_ns(u64 cycles) {
+    // Per call latencies only, clamped to 4.29 s
+    u64 ns = (cycles / BENCH_TIMER_FREQ) * 1000000000ULL + ((cycles % BENCH_TIMER_FREQ) * 1000000000ULL) / BENCH_TIMER_FREQ;
+    return (ns > 0xFFFFFFFFULL) ? 0xFFFFFFFF : (u32)ns;
+}
+
+static int latency_bucket(u64 cycles) {
+    u32 us = cycles_to_ns(cycles) / 1000;
+    int bucket = 0;
+
+    while (bucket < BENCH_HIST_BUCKETS - 1 && ((u32)1 << bucket) <= us) {
+        bucket++;
+    }
+    return bucket;
+}
+
+static u32 percentile_bound(u32* histogram, u32 num_runs, int percent) {
+    // Upper bound (us) of the bucket holding the percentile, the histogram is all there is for it
+    u32 rank = (num_runs*percent + 99) / 100;
+    u32 count = 0;
+
+    for (int bucket = 0; bucket < BENCH_HIST_BUCKETS; bucket++) {
+        count += histogram[bucket];
+        if (count >= rank) return (u32)1 << bucket;
+    }
+    return (u32)1 << (BENCH_HIST_BUCKETS - 1);
+}
+
+static void print_us(const char* key, u64 cycles) {
+    // Whole seconds and the remainder apart, so neither a long run nor a multiplication overflows
+    u64 remainder = (cycles % BENCH_TIMER_FREQ) * 1000000;
+    u64 us = (cycles / BENCH_TIMER_FREQ) * 1000000 + remainder / BENCH_TIMER_FREQ;
+    u32 ns = (u32)(((remainder % BENCH_TIMER_FREQ) * 1000) / BENCH_TIMER_FREQ);
+
+    // xil_printf has no 64-bit conversion
+    if (us >= 1000000000) {
+        xil_printf(",\"%s\":%d%09d.%03d", key, (u32)(us / 1000000000), (u32)(us % 1000000000), ns);
+    } else {
+        xil_printf(",\"%s\":%d.%03d", key, (u32)us, ns);
+    }
+}
+
+int bench_run(XTmrCtr* TimerCtrInstancePtr, const bench_backend* backend) {
+    u32 histogram[BENCH_HIST_BUCKETS] = {0};
+    u64 min_latency = ~(u64)0;
+    u64 max_latency = 0;
+    u64 total_latency = 0;
+    u32 num_runs = 0;
+
+    u64 start_time = timer_get_value64(TimerCtrInstancePtr);
+    u64 now = start_time;
+
+    while ((BENCH_SECONDS > 0) ? (now - start_time < (u64)BENCH_SECONDS*BENCH_TIMER_FREQ) : (num_runs < BENCH_ITERATIONS)) {
+        if (backend->run() != XST_SUCCESS) {
+            xil_printf("%s failed in run %d of the benchmark\n", backend->name, num_runs);
+            return XST_FAILURE;
+        }
+
+        // Latency of a call is from the previous timestamp, nothing else runs in between
+        u64 end_time = timer_get_value64(TimerCtrInstancePtr);
+        u64 latency = end_time - now;
+        now = end_time;
+
+        histogram[latency_bucket(latency)]++;
+        if (latency < min_latency) min_latency = latency;
+        if (latency > max_latency) max_latency = latency;
+        total_latency += latency;
+        num_runs++;
+    }
+
+    u64 elapsed = now - start_time;
+    if (elapsed == 0) elapsed = 1;
+    u64 num_batches = (u64)num_runs*backend->batches_per_run;
+    u32 inferences_per_s = (u32)((num_batches*A_NUM_ROWS*BENCH_TIMER_FREQ) / elapsed);
+    u32 kbytes_per_s = (u32)((num_batches*(NUMBER_OF_INPUT_WORDS + NUMBER_OF_OUTPUT_WORDS)*WORD_SIZE_IN_BYTES*BENCH_TIMER_FREQ) / (elapsed*1000));   // Batch in, results out
+
+    // One line, so a script can grep for "BENCH " and parse the rest as JSON
+    xil_printf("BENCH {\"backend\":\"%s\",\"runs\":%d,\"batches\":%d,\"inferences\":%d", backend->name, num_runs,
+               (u32)num_batches, (u32)num_batches*A_NUM_ROWS);
+    print_us("time_us", elapsed);
+    xil_printf(",\"inferences_per_s\":%d,\"kbytes_per_s\":%d", inferences_per_s, kbytes_per_s);
+    print_us("latency_min_us", min_latency);
+    print_us("latency_mean_us", (num_runs > 0) ? total_latency / num_runs : 0);
+    print_us("latency_max_us", max_latency);
+    xil_printf(",\"latency_p50_us_below\":%d,\"latency_p99_us_below\":%d", percentile_bound(histogram, num_runs, 50),
+               percentile_bound(histogram, num_runs, 99));
+    xil_printf(",\"histogram_us_below\":{");
+    int first = 1;
+    for (int bucket = 0; bucket < BENCH_HIST_BUCKETS; bucket++) {
+        if (histogram[bucket] == 0) continue;
+        xil_printf("%s\"%d\":%d", first ? "" : ",", (u32)1 << bucket, histogram[bucket]);
+        first = 0;
+    }
+    xil_printf("}}\n");
+
+    return XST_SUCCESS;
+}
\ No newline at end of file
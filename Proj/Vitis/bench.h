@@ -0,0 +1,29 @@
+#ifndef COMMON_HEADER
+    #define COMMON_HEADER
+    #include "common.h"
+#endif
+
+#include "timer.h"
+
+// Sustained throughput (inferences/s, kB/s of batches in and results out): the received batch is replayed through every backend of the build, one backend after the other
+// Each call of a backend is timed on the 64-bit timer, into a log2 latency histogram
+// Summary is one line per backend, "BENCH {json}", for scripts to pick up from the UART log
+// Host build: same code, with SOFT_processing and the C++ model of the coprocessor behind the emulated FIFO/DMA (make bench-throughput)
+//#define BENCHMARK_MODE
+
+#ifndef BENCH_ITERATIONS
+    #define BENCH_ITERATIONS    1000    // Calls per backend
+#endif
+#ifndef BENCH_SECONDS
+    #define BENCH_SECONDS       0       // Run each backend this long instead, when > 0
+#endif
+#define BENCH_HIST_BUCKETS      24      // Bucket k counts latencies below 2^k us (and at least 2^(k-1) us), the last one everything above
+#define BENCH_TIMER_FREQ        XPAR_TMRCTR_0_CLOCK_FREQ_HZ
+
+typedef struct {
+    const char* name;
+    int (*run)();               // Processes 'batches_per_run' batches of the ingest buffer, XST_SUCCESS/XST_FAILURE
+    int batches_per_run;
+} bench_backend;
+
+int bench_run(XTmrCtr* TimerCtrInstancePtr, const bench_backend* backend);
\ No newline at end of file
@@ -4,10 +4,28 @@
 #include "xil_printf.h"
 #include "stdio.h"
 
+// Two-stage (cascade) inference, must match the coprocessor (Proj/HLS)
+// A linear screen decides the confident datapoints, only those inside the uncertainty band go through the full MLP
+//#define CASCADE_MODE
+
 #define WORD_SIZE_IN_BYTES 4
-#define NUMBER_OF_INPUT_WORDS 467
+#ifdef CASCADE_MODE
+    #define NUMBER_OF_INPUT_WORDS 477   // A, B, C, then S (screen weights) and the uncertainty band
+#else
+    #define NUMBER_OF_INPUT_WORDS 467
+#endif
 #define NUMBER_OF_OUTPUT_WORDS 64
-#define NUMBER_OF_TEST_VECTORS 1
+#ifndef NUMBER_OF_TEST_VECTORS
+    #define NUMBER_OF_TEST_VECTORS 1    // Batches in the ingest buffer, the files only carry one, further ones are copies of it
+#endif
+#define CACHE_LINE_SIZE 64          // Cortex-A53 L1/L2 line, DMA buffers start on one so flush/invalidate never share a line
+
+#define NUM_FRACTIONAL_BITS 8
+#define NUM_WEIGHTS_INPUT_TO_HIDDEN 8    // 7(weight connections) + 1(bias)
+#define NUM_WEIGHTS_HIDDEN_TO_OUTPUT 3   // 2(weight connections) + 1(bias)
+#define NUM_NEURONS_INPUT_LAYER 7
+#define NUM_NEURONS_HIDDEN_LAYER 2
+#define NUM_NEURONS_OUTPUT_LAYER 1
 
 #define A_NUM_ROWS 64
 #define A_NUM_COLS 7
@@ -21,4 +39,29 @@
 
 #define C_NUM_ROWS 3
 #define C_NUM_COLS 1
-#define C_DISREGARD_BIAS_TERM 1
\ No newline at end of file
+#define C_DISREGARD_BIAS_TERM 1
+
+#define S_NUM_ROWS 8        // 7(weight connections) + 1(bias) of the screen neuron
+#define S_NUM_COLS 1
+#define S_DISREGARD_BIAS_TERM 1
+#define BAND_NUM_WORDS 2    // Lower and upper bound (inclusive) of the uncertainty band
+#define CASCADE_STAGE_SCREEN 1
+#define CASCADE_STAGE_FULL 2
+#define CASCADE_STAGE_SHIFT 8   // Coprocessor output word is (stage << 8) | result
+
+// Resident weights (ONLINE_TRAINING of Proj/HLS), every transaction then starts with an opcode word
+// The PS only infers, through the model registry (model_registry.h)
+#define OPCODE_INFER            0   // A, B, C, which become the resident weights
+#define OPCODE_INFER_RESIDENT   1   // A only, with the resident weights
+#define OPCODE_TRAIN            2
+#define OPCODE_READ_WEIGHTS     3
+#define OPCODE_MASK             0xFF
+#define OPCODE_MODEL_SHIFT      8   // Opcode word is (model handle << 8) | opcode, the coprocessor ignores the handle
+#define NUMBER_OF_WEIGHT_WORDS  (B_NUM_ROWS*B_NUM_COLS + C_NUM_ROWS*C_NUM_COLS)
+
+// Offsets (in words) of each matrix within a batch of the coprocessor input, i.e of the ingest buffer
+#define A_OFFSET    0
+#define B_OFFSET    (A_OFFSET + A_NUM_ROWS*A_NUM_COLS)
+#define C_OFFSET    (B_OFFSET + B_NUM_ROWS*B_NUM_COLS)
+#define S_OFFSET    (C_OFFSET + C_NUM_ROWS*C_NUM_COLS)
+#define BAND_OFFSET (S_OFFSET + S_NUM_ROWS*S_NUM_COLS)
\ No newline at end of file
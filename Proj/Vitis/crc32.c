@@ -0,0 +1,34 @@
+#include "crc32.h"
+
+// Table driven, one lookup per byte
+static u32 crc32_table[256];
+static int crc32_table_ready = 0;
+
+void crc32_init() {
+    if (crc32_table_ready) return;
+
+    for (u32 i = 0; i < 256; i++) {
+        u32 crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ CRC32_POLYNOMIAL : (crc >> 1);
+        }
+        crc32_table[i] = crc;
+    }
+
+    crc32_table_ready = 1;
+}
+
+
+u32 crc32_update_byte(u32 crc, u8 data) {
+    return (crc >> 8) ^ crc32_table[(crc ^ data) & 0xFF];
+}
+
+
+u32 crc32_update(u32 crc, const u8* data, int num_bytes) {
+    // Start with crc = CRC32_INITIAL, XOR the result with CRC32_FINAL_XOR once all data went through
+    for (int i = 0; i < num_bytes; i++) {
+        crc = crc32_update_byte(crc, data[i]);
+    }
+
+    return crc;
+}
\ No newline at end of file
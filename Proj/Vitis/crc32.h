@@ -0,0 +1,13 @@
+#ifndef COMMON_HEADER
+    #define COMMON_HEADER
+    #include "common.h"
+#endif
+
+// CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320), same as zlib.crc32 / binascii.crc32 on the host
+#define CRC32_POLYNOMIAL    0xEDB88320u
+#define CRC32_INITIAL       0xFFFFFFFFu
+#define CRC32_FINAL_XOR     0xFFFFFFFFu
+
+void crc32_init();
+u32 crc32_update(u32 crc, const u8* data, int num_bytes);
+u32 crc32_update_byte(u32 crc, u8 data);
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "dma_arena.h"
+
+static u8 dma_arena[DMA_ARENA_SIZE] __attribute__ ((aligned (DMA_ARENA_ALIGN)));
+static u32 dma_arena_next = 0;     // Bytes handed out so far, always a whole number of cache lines
+
+int dma_arena_init() {
+    dma_arena_next = 0;
+
+    #ifdef DMA_ARENA_NONCACHEABLE
+        // No line of the arena may still be in the cache once it is mapped non-cacheable
+        Xil_DCacheFlushRange((UINTPTR)dma_arena, DMA_ARENA_SIZE);
+        Xil_SetTlbAttributes((UINTPTR)dma_arena, NORM_NONCACHE);
+        dsb();
+    #endif
+
+    return XST_SUCCESS;
+}
+
+void* dma_arena_alloc(u32 bytes) {
+    // Buffers live as long as the application, there is no free
+    u32 size = DMA_BUFFER_BYTES(bytes);
+    if (size > DMA_ARENA_SIZE - dma_arena_next) return NULL;
+
+    void* buffer = &dma_arena[dma_arena_next];
+    dma_arena_next += size;
+    return buffer;
+}
+
+u32 dma_arena_used() {
+    return dma_arena_next;
+}
+
+void dma_flush(const void* buffer, u32 bytes) {
+    // Before the DMA reads the buffer (MM2S): CPU writes must have reached memory
+    #ifdef DMA_ARENA_NONCACHEABLE
+        (void)buffer;
+        (void)bytes;
+        dsb();
+    #else
+        UINTPTR start = (UINTPTR)buffer & ~(UINTPTR)(CACHE_LINE_SIZE - 1);
+        Xil_DCacheFlushRange(start, DMA_BUFFER_BYTES((UINTPTR)buffer + bytes) - start);
+    #endif
+}
+
+void dma_invalidate(void* buffer, u32 bytes) {
+    // Before the DMA writes the buffer (S2MM), so no dirty line is evicted over the new data later,
+    // and after, so the CPU does not read lines it fetched (or prefetched) in the meantime
+    // Whole lines are dropped, a range which does not start and end on a line would lose the CPU writes next to it
+    #ifdef DMA_ARENA_NONCACHEABLE
+        (void)buffer;
+        (void)bytes;
+        dsb();
+    #else
+        UINTPTR start = (UINTPTR)buffer & ~(UINTPTR)(CACHE_LINE_SIZE - 1);
+        Xil_DCacheInvalidateRange(start, DMA_BUFFER_BYTES((UINTPTR)buffer + bytes) - start);
+    #endif
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef COMMON_HEADER
+    #define COMMON_HEADER
+    #include "common.h"
+#endif
+
+#include "xil_cache.h"
+#include "xil_mmu.h"
+#include "xpseudo_asm.h"
+
+// Buffers the DMA reads or writes (HARD_input_memory, HARD_result_memory) come from this arena
+// Each one starts on a cache line and is rounded up to whole lines, so flushing/invalidating a buffer never touches a neighbour
+// dma_flush/dma_invalidate take a length in BYTES and cover every line of the range
+// Non-cacheable arena: the arena's MMU block is mapped Normal non-cacheable, flush/invalidate then are only a barrier
+//  - The A53 translation table maps DDR in 2MB blocks, so the arena takes a whole block of its own
+//  - CPU accesses to the buffers get slower (no cache), SOFT reads the ingest buffer in place, measure both ways
+//#define DMA_ARENA_NONCACHEABLE
+
+#define DMA_ARENA_BLOCK_SIZE    0x200000    // MMU block, the unit Xil_SetTlbAttributes works on
+#ifdef DMA_ARENA_NONCACHEABLE
+    #define DMA_ARENA_SIZE      DMA_ARENA_BLOCK_SIZE
+    #define DMA_ARENA_ALIGN     DMA_ARENA_BLOCK_SIZE
+#else
+    #define DMA_ARENA_SIZE      0x40000     // Room for a few hundred batches each way
+    #define DMA_ARENA_ALIGN     CACHE_LINE_SIZE
+#endif
+
+#define DMA_BUFFER_BYTES(bytes) (((bytes) + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1))
+
+int dma_arena_init();
+void* dma_arena_alloc(u32 bytes);
+u32 dma_arena_used();
+void dma_flush(const void* buffer, u32 bytes);
+void dma_invalidate(void* buffer, u32 bytes);
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "hetero.h"
+
+static u32 rows_per_second(int num_rows, u32 cycles) {
+    return (u32)(((u64)num_rows * HETERO_TIMER_FREQ) / cycles);
+}
+
+static void smooth(u32* rate, u32 sample) {
+    // First sample is taken as is, later ones only move the rate part of the way (load may change, one workload may be noisy)
+    if (*rate == 0) {
+        *rate = sample;
+    }
+    else {
+        *rate += ((s64)sample - (s64)*rate) >> HETERO_RATE_SHIFT;
+    }
+}
+
+void hetero_init(hetero_scheduler* scheduler, int num_batches) {
+    // Nothing measured yet, half of the workload each
+    scheduler->num_batches = num_batches;
+    scheduler->hard_batches = num_batches / 2;
+    scheduler->hard_rate = 0;
+    scheduler->soft_rate = 0;
+    scheduler->num_rounds = 0;
+}
+
+int hetero_plan(hetero_scheduler* scheduler) {
+    // HARD batches for the next workload: the split which finishes both sides soonest, at the rates seen so far
+    // Each side keeps at least one batch (when there are two), so both rates stay measured and follow load changes
+    if (scheduler->hard_rate == 0 || scheduler->soft_rate == 0) return scheduler->hard_batches;
+
+    int min_batches = (scheduler->num_batches > 1) ? 1 : 0;
+    int max_batches = scheduler->num_batches - min_batches;
+    u64 best_time = ~(u64)0;
+
+    for (int hard_batches = min_batches; hard_batches <= max_batches; hard_batches++) {
+        // Microseconds each side needs for its share, the workload takes as long as the slower one
+        u64 hard_time = ((u64)hard_batches*A_NUM_ROWS*1000000) / scheduler->hard_rate;
+        u64 soft_time = ((u64)(scheduler->num_batches - hard_batches)*A_NUM_ROWS*1000000) / scheduler->soft_rate;
+        u64 time = (hard_time > soft_time) ? hard_time : soft_time;
+
+        if (time < best_time) {
+            best_time = time;
+            scheduler->hard_batches = hard_batches;
+        }
+    }
+
+    return scheduler->hard_batches;
+}
+
+void hetero_update(hetero_scheduler* scheduler, u32 hard_cycles, int soft_rows, u32 soft_cycles, u32 total_cycles) {
+    // HARD: its rows over the time until its last batch was received, SOFT steps in its waits included
+    // SOFT: its rows over the time spent in SOFT only, wherever it ran
+    int hard_rows = scheduler->hard_batches*A_NUM_ROWS;
+
+    if (hard_rows > 0 && hard_cycles > 0) smooth(&scheduler->hard_rate, rows_per_second(hard_rows, hard_cycles));
+    if (soft_rows > 0 && soft_cycles > 0) smooth(&scheduler->soft_rate, rows_per_second(soft_rows, soft_cycles));
+
+    if (scheduler->num_rounds < HETERO_ROUNDS) {
+        scheduler->rounds[scheduler->num_rounds].hard_batches = scheduler->hard_batches;
+        scheduler->rounds[scheduler->num_rounds].time = total_cycles;
+        scheduler->num_rounds++;
+    }
+}
+
+void hetero_print_stats(hetero_scheduler* scheduler) {
+    int num_rows = scheduler->num_batches*A_NUM_ROWS;
+
+    for (int round = 0; round < scheduler->num_rounds; round++) {
+        hetero_round* stats = &scheduler->rounds[round];
+        u32 rate = (stats->time > 0) ? rows_per_second(num_rows, stats->time) : 0;
+
+        xil_printf("\nSplit round %d: HARD %d of %d batches, %d cycles, %d rows/s", round, stats->hard_batches, scheduler->num_batches, stats->time, rate);
+    }
+    xil_printf("\nSplit rates: HARD %d rows/s, SOFT %d rows/s", scheduler->hard_rate, scheduler->soft_rate);
+}
\ No newline at end of file
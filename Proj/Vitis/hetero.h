@@ -0,0 +1,38 @@
+#ifndef COMMON_HEADER
+    #define COMMON_HEADER
+    #include "common.h"
+#endif
+
+#include "soft_simd.h"
+
+// Heterogeneous split: one workload (the NUMBER_OF_TEST_VECTORS batches of the ingest buffer) is shared by HARD and SOFT at the same time
+// HARD takes the first batches, SOFT the remaining ones, SOFT rows run whenever the CPU would otherwise wait on the coprocessor (HARD_idle)
+// The split comes from the rows per second each side reached on the previous workloads (smoothed), it is recomputed before every workload
+// Results are merged in place, batch k always ends up in HARD_result_memory[k*NUMBER_OF_OUTPUT_WORDS], whichever side computed it
+// Overlap needs an interrupt driven transport (HARD_HLS, AXI_DMA_INTERRUPT_MODE), with a polling one SOFT only gets the CPU after HARD
+//#define HETERO_SPLIT
+
+#define HETERO_ROUNDS       8                       // Workloads run by main(), the split settles within the first few
+#define HETERO_STEP_ROWS    SOFT_SIMD_BLOCK_ROWS    // SOFT rows per HARD_idle call, keeps the next interrupt from waiting long on SOFT
+#define HETERO_RATE_SHIFT   2                       // Rates are smoothed as rate += (sample - rate) >> HETERO_RATE_SHIFT
+#define HETERO_TIMER_FREQ   XPAR_TMRCTR_0_CLOCK_FREQ_HZ
+
+typedef struct {
+    int hard_batches;
+    u32 time;               // Cycles, from the first HARD batch sent to the last result merged
+} hetero_round;
+
+typedef struct {
+    int num_batches;
+    int hard_batches;       // HARD share of the next workload, SOFT gets the rest
+    u32 hard_rate;          // Rows per second, smoothed, 0 until measured
+    u32 soft_rate;
+
+    hetero_round rounds[HETERO_ROUNDS];
+    int num_rounds;
+} hetero_scheduler;
+
+void hetero_init(hetero_scheduler* scheduler, int num_batches);
+int hetero_plan(hetero_scheduler* scheduler);
+void hetero_update(hetero_scheduler* scheduler, u32 hard_cycles, int soft_rows, u32 soft_cycles, u32 total_cycles);
+void hetero_print_stats(hetero_scheduler* scheduler);
\ No newline at end of file
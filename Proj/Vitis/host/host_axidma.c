@@ -0,0 +1,402 @@
+// Host emulation of the AXI DMA driver (simple and scatter-gather mode), connected to the coprocessor model
+#include <string.h>
+
+#include "xparameters.h"
+#include "xaxidma.h"
+#include "xscugic.h"
+#include "host_coprocessor.h"
+
+#define HOST_DMA_MAX_PACKET_WORDS 4096     // Largest MM2S packet the model accepts in scatter-gather mode
+
+static XAxiDma_Config dma_config = {
+    .DeviceId = XPAR_AXIDMA_0_DEVICE_ID,
+    .BaseAddr = XPAR_AXIDMA_0_BASEADDR,
+    .HasMm2S = 1,
+    .HasS2Mm = 1,
+    .Mm2SDataWidth = 32,
+    .S2MmDataWidth = 32,
+    .HasSg = XPAR_AXIDMA_0_INCLUDE_SG,
+    .Mm2sNumChannels = 1,
+    .S2MmNumChannels = 1,
+    .AddrWidth = 64,
+    .SgLengthWidth = 26,
+};
+
+static const u32 dma_irq_id[2] = {XPAR_FABRIC_AXIDMA_0_MM2S_INTROUT_VEC_ID, XPAR_FABRIC_AXIDMA_0_S2MM_INTROUT_VEC_ID};
+
+static void complete(XAxiDma* InstancePtr, int Direction) {
+    XAxiDma_Channel* channel = &InstancePtr->Channel[Direction];
+
+    channel->Busy = 0;
+    channel->IntrStatus |= XAXIDMA_IRQ_IOC_MASK;
+    if (channel->IntrStatus & channel->IntrMask) host_raise_interrupt(dma_irq_id[Direction]);
+}
+
+// Rings are only reachable through the instance, remember it for the engine
+static XAxiDma* sg_instance = NULL;
+
+static void process_rings(XAxiDma* InstancePtr);
+
+static void try_complete_s2mm(XAxiDma* InstancePtr) {
+    XAxiDma_Channel* channel = &InstancePtr->Channel[XAXIDMA_DEVICE_TO_DMA];
+
+    if (!channel->Busy || !host_coprocessor_rx_packets()) return;
+
+    // Transfer ends on TLAST, or when the programmed length is used up
+    u32* dest = (u32*)channel->BuffAddr;
+    u32 packet_words = host_coprocessor_rx_packet_words();
+    for (u32 i = 0; i < packet_words && i < channel->Length/4; i++) {
+        dest[i] = host_coprocessor_rx_pop_word();
+    }
+
+    complete(InstancePtr, XAXIDMA_DEVICE_TO_DMA);
+}
+
+XAxiDma_Config* XAxiDma_LookupConfig(u32 DeviceId) {
+    return (DeviceId == XPAR_AXIDMA_0_DEVICE_ID) ? &dma_config : NULL;
+}
+
+int XAxiDma_CfgInitialize(XAxiDma* InstancePtr, XAxiDma_Config* Config) {
+    InstancePtr->RegBase = Config->BaseAddr;
+    InstancePtr->HasMm2S = Config->HasMm2S;
+    InstancePtr->HasS2Mm = Config->HasS2Mm;
+    InstancePtr->HasSg = Config->HasSg;
+    InstancePtr->TxBdRing.MaxTransferLen = (1U << Config->SgLengthWidth) - 1;
+    InstancePtr->TxBdRing.IsRxChannel = 0;
+    InstancePtr->TxBdRing.RunState = 0;
+    InstancePtr->RxBdRing[0].MaxTransferLen = (1U << Config->SgLengthWidth) - 1;
+    InstancePtr->RxBdRing[0].IsRxChannel = 1;
+    InstancePtr->RxBdRing[0].RunState = 0;
+    XAxiDma_Reset(InstancePtr);
+    InstancePtr->Initialized = 1;
+    sg_instance = InstancePtr;
+
+    return XST_SUCCESS;
+}
+
+void XAxiDma_Reset(XAxiDma* InstancePtr) {
+    for (int dir = XAXIDMA_DMA_TO_DEVICE; dir <= XAXIDMA_DEVICE_TO_DMA; dir++) {
+        InstancePtr->Channel[dir].IntrMask = 0;
+        InstancePtr->Channel[dir].IntrStatus = 0;
+        InstancePtr->Channel[dir].Busy = 0;
+        InstancePtr->Channel[dir].BuffAddr = 0;
+        InstancePtr->Channel[dir].Length = 0;
+    }
+}
+
+int XAxiDma_ResetIsDone(XAxiDma* InstancePtr) {
+    (void)InstancePtr;
+
+    return TRUE;
+}
+
+u32 XAxiDma_SimpleTransfer(XAxiDma* InstancePtr, UINTPTR BuffAddr, u32 Length, int Direction) {
+    XAxiDma_Channel* channel = &InstancePtr->Channel[Direction];
+
+    if (InstancePtr->HasSg) return XST_FAILURE;
+    if (channel->Busy) return XST_FAILURE;
+
+    channel->BuffAddr = BuffAddr;
+    channel->Length = Length;
+    channel->Busy = 1;
+
+    if (Direction == XAXIDMA_DMA_TO_DEVICE) {
+        host_coprocessor_transaction((const u32*)BuffAddr, Length/4);
+        complete(InstancePtr, XAXIDMA_DMA_TO_DEVICE);
+    }
+
+    // S2MM may have been armed before the data it waits for
+    try_complete_s2mm(InstancePtr);
+
+    return XST_SUCCESS;
+}
+
+u32 XAxiDma_Busy(XAxiDma* InstancePtr, int Direction) {
+    return InstancePtr->Channel[Direction].Busy ? TRUE : FALSE;
+}
+
+void XAxiDma_IntrEnable(XAxiDma* InstancePtr, u32 Mask, int Direction) {
+    InstancePtr->Channel[Direction].IntrMask |= (Mask & XAXIDMA_IRQ_ALL_MASK);
+}
+
+void XAxiDma_IntrDisable(XAxiDma* InstancePtr, u32 Mask, int Direction) {
+    InstancePtr->Channel[Direction].IntrMask &= ~Mask;
+}
+
+u32 XAxiDma_IntrGetIrq(XAxiDma* InstancePtr, int Direction) {
+    return InstancePtr->Channel[Direction].IntrStatus & XAXIDMA_IRQ_ALL_MASK;
+}
+
+void XAxiDma_IntrAckIrq(XAxiDma* InstancePtr, u32 Mask, int Direction) {
+    InstancePtr->Channel[Direction].IntrStatus &= ~Mask;
+}
+
+
+/*********************************** Scatter-gather *********************************************/
+static int ring_index(XAxiDma_BdRing* RingPtr, XAxiDma_Bd* BdPtr) {
+    return (int)(BdPtr - RingPtr->FirstBd);
+}
+
+static int ring_advance(XAxiDma_BdRing* RingPtr, int index, int count) {
+    return (index + count) % RingPtr->AllCnt;
+}
+
+static void raise_ring_irq(XAxiDma* InstancePtr, int Direction) {
+    XAxiDma_Channel* channel = &InstancePtr->Channel[Direction];
+
+    channel->IntrStatus |= XAXIDMA_IRQ_IOC_MASK;
+    if (channel->IntrStatus & channel->IntrMask) host_raise_interrupt(dma_irq_id[Direction]);
+}
+
+static int process_tx_ring(XAxiDma_BdRing* RingPtr) {
+    // Gather BDs up to TXEOF into one packet for the model
+    static u32 packet[HOST_DMA_MAX_PACKET_WORDS];
+    int processed = 0;
+
+    while (RingPtr->HwPending > 0) {
+        int num_bds = 0;
+        u32 num_words = 0;
+        int index = RingPtr->HwCursor;
+        int has_eof = 0;
+
+        while (num_bds < RingPtr->HwPending && !has_eof) {
+            XAxiDma_Bd* bd = &RingPtr->FirstBd[index];
+            u32 bytes = bd->Control & RingPtr->MaxTransferLen;
+
+            if (num_words + bytes/4 <= HOST_DMA_MAX_PACKET_WORDS) {
+                memcpy(&packet[num_words], (const void*)bd->BufAddr, bytes);
+            }
+            num_words += bytes/4;
+            has_eof = (bd->Control & XAXIDMA_BD_CTRL_TXEOF_MASK) != 0;
+            index = ring_advance(RingPtr, index, 1);
+            num_bds++;
+        }
+
+        // Packet not complete yet, the engine waits for the rest of its BDs
+        if (!has_eof) break;
+
+        host_coprocessor_transaction(packet, num_words);
+
+        for (int k = 0; k < num_bds; k++) {
+            XAxiDma_Bd* bd = &RingPtr->FirstBd[RingPtr->HwCursor];
+            bd->Status = XAXIDMA_BD_STS_COMPLETE_MASK | (bd->Control & RingPtr->MaxTransferLen);
+            RingPtr->HwCursor = ring_advance(RingPtr, RingPtr->HwCursor, 1);
+        }
+        RingPtr->HwPending -= num_bds;
+        processed += num_bds;
+    }
+
+    return processed;
+}
+
+static int process_rx_ring(XAxiDma_BdRing* RingPtr) {
+    // Scatter each packet of the model over as many BDs as it needs
+    int processed = 0;
+
+    while (RingPtr->HwPending > 0 && host_coprocessor_rx_packets()) {
+        int first = 1;
+        u32 remaining = host_coprocessor_rx_packet_words();
+
+        while (remaining > 0 && RingPtr->HwPending > 0) {
+            XAxiDma_Bd* bd = &RingPtr->FirstBd[RingPtr->HwCursor];
+            u32 capacity = (bd->Control & RingPtr->MaxTransferLen)/4;
+            u32* dest = (u32*)bd->BufAddr;
+            u32 num_words = (remaining < capacity) ? remaining : capacity;
+
+            for (u32 i = 0; i < num_words; i++) {
+                dest[i] = host_coprocessor_rx_pop_word();
+            }
+            remaining -= num_words;
+
+            bd->Status = XAXIDMA_BD_STS_COMPLETE_MASK | (num_words*4);
+            if (first) bd->Status |= XAXIDMA_BD_STS_RXSOF_MASK;
+            if (remaining == 0) bd->Status |= XAXIDMA_BD_STS_RXEOF_MASK;
+            first = 0;
+
+            RingPtr->HwCursor = ring_advance(RingPtr, RingPtr->HwCursor, 1);
+            RingPtr->HwPending--;
+            processed++;
+        }
+    }
+
+    return processed;
+}
+
+static void process_rings(XAxiDma* InstancePtr) {
+    if (InstancePtr == NULL) return;
+
+    XAxiDma_BdRing* tx_ring = XAxiDma_GetTxRing(InstancePtr);
+    XAxiDma_BdRing* rx_ring = XAxiDma_GetRxRing(InstancePtr);
+
+    if (tx_ring->RunState && process_tx_ring(tx_ring)) raise_ring_irq(InstancePtr, XAXIDMA_DMA_TO_DEVICE);
+    if (rx_ring->RunState && process_rx_ring(rx_ring)) raise_ring_irq(InstancePtr, XAXIDMA_DEVICE_TO_DMA);
+}
+
+u32 XAxiDma_BdRingCntCalc(u32 Alignment, u32 Bytes) {
+    u32 bd_size = (sizeof(XAxiDma_Bd) + Alignment - 1) & ~(Alignment - 1);
+
+    return Bytes / bd_size;
+}
+
+int XAxiDma_BdRingCreate(XAxiDma_BdRing* RingPtr, UINTPTR PhysAddr, UINTPTR VirtAddr, u32 Alignment, int BdCount) {
+    (void)PhysAddr;
+
+    if (BdCount <= 0 || (VirtAddr & (Alignment - 1)) || Alignment < XAXIDMA_BD_MINIMUM_ALIGNMENT) return XST_INVALID_PARAM;
+
+    RingPtr->FirstBd = (XAxiDma_Bd*)VirtAddr;
+    RingPtr->AllCnt = BdCount;
+    RingPtr->FreeHead = RingPtr->PreHead = RingPtr->HwHead = RingPtr->PostHead = 0;
+    RingPtr->FreeCnt = BdCount;
+    RingPtr->PreCnt = RingPtr->HwCnt = RingPtr->PostCnt = 0;
+    RingPtr->HwCursor = 0;
+    RingPtr->HwPending = 0;
+    RingPtr->RunState = 0;
+
+    memset(RingPtr->FirstBd, 0, BdCount*sizeof(XAxiDma_Bd));
+    for (int i = 0; i < BdCount; i++) {
+        RingPtr->FirstBd[i].NextDesc = (UINTPTR)&RingPtr->FirstBd[ring_advance(RingPtr, i, 1)];
+    }
+
+    return XST_SUCCESS;
+}
+
+int XAxiDma_BdRingClone(XAxiDma_BdRing* RingPtr, XAxiDma_Bd* SrcBdPtr) {
+    if (RingPtr->FreeCnt != RingPtr->AllCnt) return XST_DMA_SG_LIST_ERROR;
+
+    for (int i = 0; i < RingPtr->AllCnt; i++) {
+        UINTPTR next = RingPtr->FirstBd[i].NextDesc;
+        RingPtr->FirstBd[i] = *SrcBdPtr;
+        RingPtr->FirstBd[i].NextDesc = next;
+        RingPtr->FirstBd[i].Status = 0;
+    }
+
+    return XST_SUCCESS;
+}
+
+int XAxiDma_BdRingStart(XAxiDma_BdRing* RingPtr) {
+    RingPtr->RunState = 1;
+
+    process_rings(sg_instance);
+
+    return XST_SUCCESS;
+}
+
+int XAxiDma_BdRingAlloc(XAxiDma_BdRing* RingPtr, int NumBd, XAxiDma_Bd** BdSetPtr) {
+    if (NumBd <= 0 || RingPtr->FreeCnt < NumBd) return XST_FAILURE;
+
+    *BdSetPtr = &RingPtr->FirstBd[RingPtr->FreeHead];
+    RingPtr->FreeHead = ring_advance(RingPtr, RingPtr->FreeHead, NumBd);
+    RingPtr->FreeCnt -= NumBd;
+    RingPtr->PreCnt += NumBd;
+
+    return XST_SUCCESS;
+}
+
+int XAxiDma_BdRingUnAlloc(XAxiDma_BdRing* RingPtr, int NumBd, XAxiDma_Bd* BdSetPtr) {
+    // Only the most recently allocated BDs can be given back
+    if (NumBd <= 0 || RingPtr->PreCnt < NumBd || ring_advance(RingPtr, ring_index(RingPtr, BdSetPtr), NumBd) != RingPtr->FreeHead) return XST_FAILURE;
+
+    RingPtr->FreeHead = ring_index(RingPtr, BdSetPtr);
+    RingPtr->PreCnt -= NumBd;
+    RingPtr->FreeCnt += NumBd;
+
+    return XST_SUCCESS;
+}
+
+int XAxiDma_BdRingToHw(XAxiDma_BdRing* RingPtr, int NumBd, XAxiDma_Bd* BdSetPtr) {
+    if (NumBd <= 0 || RingPtr->PreCnt < NumBd || ring_index(RingPtr, BdSetPtr) != RingPtr->PreHead) return XST_DMA_SG_LIST_ERROR;
+
+    XAxiDma_Bd* bd = BdSetPtr;
+    for (int i = 0; i < NumBd; i++) {
+        if ((bd->Control & RingPtr->MaxTransferLen) == 0) return XST_INVALID_PARAM;
+
+        bd->Status = 0;
+        bd = XAxiDma_BdRingNext(RingPtr, bd);
+    }
+
+    RingPtr->PreHead = ring_advance(RingPtr, RingPtr->PreHead, NumBd);
+    RingPtr->PreCnt -= NumBd;
+    RingPtr->HwCnt += NumBd;
+    RingPtr->HwPending += NumBd;
+
+    process_rings(sg_instance);
+
+    return XST_SUCCESS;
+}
+
+int XAxiDma_BdRingFromHw(XAxiDma_BdRing* RingPtr, int BdLimit, XAxiDma_Bd** BdSetPtr) {
+    int count = 0;
+    int index = RingPtr->HwHead;
+
+    while (count < BdLimit && count < RingPtr->HwCnt && (RingPtr->FirstBd[index].Status & XAXIDMA_BD_STS_COMPLETE_MASK)) {
+        index = ring_advance(RingPtr, index, 1);
+        count++;
+    }
+
+    if (count == 0) {
+        *BdSetPtr = NULL;
+        return 0;
+    }
+
+    *BdSetPtr = &RingPtr->FirstBd[RingPtr->HwHead];
+    RingPtr->HwHead = index;
+    RingPtr->HwCnt -= count;
+    RingPtr->PostCnt += count;
+
+    return count;
+}
+
+int XAxiDma_BdRingFree(XAxiDma_BdRing* RingPtr, int NumBd, XAxiDma_Bd* BdSetPtr) {
+    if (NumBd <= 0 || RingPtr->PostCnt < NumBd || ring_index(RingPtr, BdSetPtr) != RingPtr->PostHead) return XST_DMA_SG_LIST_ERROR;
+
+    RingPtr->PostHead = ring_advance(RingPtr, RingPtr->PostHead, NumBd);
+    RingPtr->PostCnt -= NumBd;
+    RingPtr->FreeCnt += NumBd;
+
+    return XST_SUCCESS;
+}
+
+XAxiDma_Bd* XAxiDma_BdRingNext(XAxiDma_BdRing* RingPtr, XAxiDma_Bd* BdPtr) {
+    return &RingPtr->FirstBd[ring_advance(RingPtr, ring_index(RingPtr, BdPtr), 1)];
+}
+
+static XAxiDma_Channel* ring_channel(XAxiDma_BdRing* RingPtr) {
+    return &sg_instance->Channel[RingPtr->IsRxChannel ? XAXIDMA_DEVICE_TO_DMA : XAXIDMA_DMA_TO_DEVICE];
+}
+
+void XAxiDma_BdRingIntEnable(XAxiDma_BdRing* RingPtr, u32 Mask) {
+    ring_channel(RingPtr)->IntrMask |= (Mask & XAXIDMA_IRQ_ALL_MASK);
+}
+
+void XAxiDma_BdRingIntDisable(XAxiDma_BdRing* RingPtr, u32 Mask) {
+    ring_channel(RingPtr)->IntrMask &= ~Mask;
+}
+
+u32 XAxiDma_BdRingGetIrq(XAxiDma_BdRing* RingPtr) {
+    return ring_channel(RingPtr)->IntrStatus & XAXIDMA_IRQ_ALL_MASK;
+}
+
+void XAxiDma_BdRingAckIrq(XAxiDma_BdRing* RingPtr, u32 Mask) {
+    ring_channel(RingPtr)->IntrStatus &= ~Mask;
+}
+
+void XAxiDma_BdClear(XAxiDma_Bd* BdPtr) {
+    memset(BdPtr, 0, sizeof(XAxiDma_Bd));
+}
+
+int XAxiDma_BdSetBufAddr(XAxiDma_Bd* BdPtr, UINTPTR Addr) {
+    // No DRE on this DMA, buffers must be word aligned
+    if (Addr & 0x3) return XST_INVALID_PARAM;
+
+    BdPtr->BufAddr = Addr;
+
+    return XST_SUCCESS;
+}
+
+int XAxiDma_BdSetLength(XAxiDma_Bd* BdPtr, u32 LenBytes, u32 LengthMask) {
+    if (LenBytes == 0 || LenBytes > LengthMask) return XST_INVALID_PARAM;
+
+    BdPtr->Control = (BdPtr->Control & ~LengthMask) | LenBytes;
+
+    return XST_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include <deque>
+#include <vector>
+#include "hls_stream.h"
+#include "ap_axi_sdata.h"
+
+#include "host_coprocessor.h"
+#include "common.h"
+
+// Same AXIS type and top-level function as Proj/HLS/myip_v1_0_HLS-1.cpp
+typedef ap_axis<32,0,0,0> AXIS_wLAST;
+void myip_v1_0_HLS(hls::stream<AXIS_wLAST>& S_AXIS, hls::stream<AXIS_wLAST>& M_AXIS);
+
+static hls::stream<AXIS_wLAST> S_AXIS;
+static hls::stream<AXIS_wLAST> M_AXIS;
+static std::deque<u32> tx_words;           // Streamed in, not yet a whole transaction
+static std::deque< std::deque<u32> > rx_packets;
+static std::deque<u32> partial_packet;     // Words streamed out without TLAST yet
+static u32 rx_total_words = 0;
+
+
+static u32 transaction_words(u32 first_word) {
+    // Words the kernel reads for the transaction starting with first_word
+#ifdef ONLINE_TRAINING
+    switch (first_word & OPCODE_MASK) {
+        case OPCODE_INFER_RESIDENT: return 1 + A_NUM_ROWS*A_NUM_COLS;
+        case OPCODE_TRAIN:          return 1 + A_NUM_ROWS*A_NUM_COLS + A_NUM_ROWS;
+        case OPCODE_READ_WEIGHTS:   return 1;
+        default:                    return 1 + NUMBER_OF_INPUT_WORDS;
+    }
+#else
+    return NUMBER_OF_INPUT_WORDS;
+#endif
+}
+
+
+void host_coprocessor_transaction(const u32* words, u32 num_words) {
+    AXIS_wLAST write_input;
+
+    tx_words.insert(tx_words.end(), words, words + num_words);
+
+    // Like the hardware, the kernel only starts once a whole transaction is there, however many packets it came in
+    while (!tx_words.empty() && tx_words.size() >= transaction_words(tx_words.front())) {
+        u32 kernel_words = transaction_words(tx_words.front());
+
+        for (u32 word_cnt = 0; word_cnt < kernel_words; word_cnt++) {
+            write_input.last = (word_cnt == kernel_words-1) ? 1 : 0;
+            write_input.data = tx_words.front();
+            tx_words.pop_front();
+            S_AXIS.write(write_input);
+        }
+        myip_v1_0_HLS(S_AXIS, M_AXIS);
+    }
+
+    // Split the output on TLAST, like AXI FIFO / AXI DMA do
+    while (!M_AXIS.empty()) {
+        AXIS_wLAST read_output = M_AXIS.read();
+        partial_packet.push_back((u32)read_output.data);
+
+        if (read_output.last) {
+            rx_total_words += partial_packet.size();
+            rx_packets.push_back(partial_packet);
+            partial_packet.clear();
+        }
+    }
+}
+
+
+u32 host_coprocessor_rx_packets(void) {
+    return rx_packets.size();
+}
+
+
+u32 host_coprocessor_rx_words(void) {
+    return rx_total_words;
+}
+
+
+u32 host_coprocessor_rx_packet_words(void) {
+    return rx_packets.empty() ? 0 : rx_packets.front().size();
+}
+
+
+u32 host_coprocessor_rx_pop_word(void) {
+    if (rx_packets.empty()) return 0;
+
+    u32 word = rx_packets.front().front();
+    rx_packets.front().pop_front();
+    rx_total_words--;
+
+    if (rx_packets.front().empty()) rx_packets.pop_front();
+
+    return word;
+}
\ No newline at end of file
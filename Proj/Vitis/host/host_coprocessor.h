@@ -0,0 +1,24 @@
+// Bridge between the emulated AXI-Stream FIFO / AXI DMA drivers and the C++ model of the coprocessor (Proj/HLS)
+#ifndef HOST_COPROCESSOR_H
+#define HOST_COPROCESSOR_H
+
+#include "xil_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Streams num_words into S_AXIS (TLAST on the final word), then runs myip_v1_0_HLS for every whole batch queued
+// Everything the model writes to M_AXIS is split into packets on TLAST and queued
+void host_coprocessor_transaction(const u32* words, u32 num_words);
+
+u32 host_coprocessor_rx_packets(void);      // Number of complete packets queued
+u32 host_coprocessor_rx_words(void);        // Total number of words queued, across all packets
+u32 host_coprocessor_rx_packet_words(void); // Length of the packet at the head of the queue
+u32 host_coprocessor_rx_pop_word(void);     // Pops one word of the head packet, dropping the packet when it is empty
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,60 @@
+// Host emulation of APU cores 1..3 and of WFE/SEV
+// Each core is a thread, it runs the SOFT_PARALLEL worker like the core's own application would on the board
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+
+#include "xparameters.h"
+#include "xpseudo_asm.h"
+#include "soft_parallel.h"
+
+u8 host_ocm[0x40000] __attribute__ ((aligned (64)));
+
+/*********************************** WFE/SEV *********************************************/
+// SEV sets the event register of every core, WFE returns at once if its own was set (clearing it), else sleeps until the next SEV
+static pthread_mutex_t event_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t event_cond = PTHREAD_COND_INITIALIZER;
+static u64 event_count = 0;
+static __thread u64 event_seen = 0;
+
+void host_wfe(void) {
+    pthread_mutex_lock(&event_lock);
+    if (event_count == event_seen) {
+        // Like WFE on the board (no event stream), only a SEV wakes it up, callers re-check their condition
+        pthread_cond_wait(&event_cond, &event_lock);
+    }
+    event_seen = event_count;
+    pthread_mutex_unlock(&event_lock);
+}
+
+void host_sev(void) {
+    pthread_mutex_lock(&event_lock);
+    event_count++;
+    pthread_cond_broadcast(&event_cond);
+    pthread_mutex_unlock(&event_lock);
+}
+
+/*********************************** Cores 1..3 *********************************************/
+#ifdef SOFT_PARALLEL
+static void* core_main(void* core) {
+    soft_parallel_worker((int)(intptr_t)core);
+    return NULL;
+}
+
+__attribute__ ((constructor)) static void start_cores(void) {
+    // Cores are up before main() of core 0, as after the boot image has been loaded
+    // SIGALRM (UART RX wire) is an IRQ of core 0 only, the other cores never take it
+    sigset_t irq_mask, previous_mask;
+    sigemptyset(&irq_mask);
+    sigaddset(&irq_mask, SIGALRM);
+    pthread_sigmask(SIG_BLOCK, &irq_mask, &previous_mask);
+
+    for (int core = 1; core < SOFT_NUM_CORES; core++) {
+        pthread_t thread;
+        pthread_create(&thread, NULL, core_main, (void*)(intptr_t)core);
+        pthread_detach(thread);
+    }
+
+    pthread_sigmask(SIG_SETMASK, &previous_mask, NULL);
+}
+#endif
\ No newline at end of file
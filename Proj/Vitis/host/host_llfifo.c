@@ -0,0 +1,123 @@
+// Host emulation of the AXI-Stream FIFO driver, connected to the coprocessor model
+#include <string.h>
+
+#include "xparameters.h"
+#include "xllfifo.h"
+#include "xscugic.h"
+#include "host_coprocessor.h"
+
+static XLlFifo_Config fifo_config = {XPAR_AXI_FIFO_0_DEVICE_ID, XPAR_AXI_FIFO_0_BASEADDR, 0, 0};
+
+static void update_interrupt(XLlFifo* InstancePtr) {
+    if (InstancePtr->Isr & InstancePtr->Ier) host_raise_interrupt(XPAR_FABRIC_LLFIFO_0_VEC_ID);
+}
+
+XLlFifo_Config* XLlFfio_LookupConfig(u32 DeviceId) {
+    return (DeviceId == XPAR_AXI_FIFO_0_DEVICE_ID) ? &fifo_config : NULL;
+}
+
+int XLlFifo_CfgInitialize(XLlFifo* InstancePtr, XLlFifo_Config* Config, UINTPTR EffectiveAddress) {
+    (void)Config;
+
+    InstancePtr->BaseAddress = EffectiveAddress;
+    InstancePtr->Isr = 0;
+    InstancePtr->Ier = 0;
+    InstancePtr->TxCount = 0;
+    InstancePtr->RxRemaining = 0;
+    InstancePtr->IsReady = XIL_COMPONENT_IS_READY;
+
+    return XST_SUCCESS;
+}
+
+u32 XLlFifo_Status(XLlFifo* InstancePtr) {
+    return InstancePtr->Isr;
+}
+
+void XLlFifo_IntClear(XLlFifo* InstancePtr, u32 Mask) {
+    InstancePtr->Isr &= ~Mask;
+}
+
+void XLlFifo_IntEnable(XLlFifo* InstancePtr, u32 Mask) {
+    InstancePtr->Ier |= Mask;
+    update_interrupt(InstancePtr);
+}
+
+void XLlFifo_IntDisable(XLlFifo* InstancePtr, u32 Mask) {
+    InstancePtr->Ier &= ~Mask;
+}
+
+u32 XLlFifo_IntPending(XLlFifo* InstancePtr) {
+    return InstancePtr->Isr & InstancePtr->Ier;
+}
+
+u32 XLlFifo_iTxVacancy(XLlFifo* InstancePtr) {
+    return XPAR_AXI_FIFO_0_TX_FIFO_DEPTH - InstancePtr->TxCount;
+}
+
+void XLlFifo_TxPutWord(XLlFifo* InstancePtr, u32 Word) {
+    // Like the hardware, writing into a full FIFO is an overrun and the word is lost
+    if (InstancePtr->TxCount == XPAR_AXI_FIFO_0_TX_FIFO_DEPTH) {
+        InstancePtr->Isr |= XLLF_INT_TPOE_MASK;
+        return;
+    }
+
+    InstancePtr->TxBuffer[InstancePtr->TxCount++] = Word;
+}
+
+int XLlFifo_Write(XLlFifo* InstancePtr, void* BufPtr, u32 Bytes) {
+    u32* words = (u32*)BufPtr;
+
+    for (u32 i = 0; i < Bytes/4; i++) {
+        XLlFifo_TxPutWord(InstancePtr, words[i]);
+    }
+
+    return XST_SUCCESS;
+}
+
+void XLlFifo_iTxSetLen(XLlFifo* InstancePtr, u32 Bytes) {
+    u32 num_words = Bytes/4;
+    if (num_words > InstancePtr->TxCount) num_words = InstancePtr->TxCount;
+
+    // Whole packet goes out in one go, the model runs as soon as it has TLAST
+    host_coprocessor_transaction(InstancePtr->TxBuffer, num_words);
+
+    memmove(InstancePtr->TxBuffer, InstancePtr->TxBuffer + num_words, (InstancePtr->TxCount - num_words)*sizeof(u32));
+    InstancePtr->TxCount -= num_words;
+
+    InstancePtr->Isr |= XLLF_INT_TC_MASK | XLLF_INT_TFPE_MASK;
+    if (host_coprocessor_rx_packets()) InstancePtr->Isr |= XLLF_INT_RC_MASK;
+
+    update_interrupt(InstancePtr);
+}
+
+u32 XLlFifo_iRxOccupancy(XLlFifo* InstancePtr) {
+    (void)InstancePtr;
+
+    return host_coprocessor_rx_words();
+}
+
+u32 XLlFifo_iRxGetLen(XLlFifo* InstancePtr) {
+    InstancePtr->RxRemaining = host_coprocessor_rx_packet_words();
+
+    return InstancePtr->RxRemaining*4;
+}
+
+u32 XLlFifo_RxGetWord(XLlFifo* InstancePtr) {
+    if (InstancePtr->RxRemaining == 0) {
+        InstancePtr->Isr |= XLLF_INT_RPUE_MASK;
+        return 0;
+    }
+
+    InstancePtr->RxRemaining--;
+    return host_coprocessor_rx_pop_word();
+}
+
+int XLlFifo_Read(XLlFifo* InstancePtr, void* BufPtr, u32 Bytes) {
+    u32* words = (u32*)BufPtr;
+
+    for (u32 i = 0; i < Bytes/4; i++) {
+        words[i] = XLlFifo_RxGetWord(InstancePtr);
+    }
+
+    return XST_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,231 @@
+// Host emulation of xil_printf, the exception table, SCUGIC, AXI Timer and the global timer
+#include <stdio.h>
+#include <stdarg.h>
+#include <signal.h>
+#include <time.h>
+
+#include "xparameters.h"
+#include "xil_printf.h"
+#include "xscugic.h"
+#include "xtmrctr.h"
+#include "xtime_l.h"
+
+/*********************************** xil_printf *********************************************/
+void xil_printf(const char* ctrl1, ...) {
+    va_list args;
+
+    va_start(args, ctrl1);
+    vprintf(ctrl1, args);
+    va_end(args);
+
+    fflush(stdout);
+}
+
+/*********************************** Exceptions *********************************************/
+static Xil_ExceptionHandler irq_handler = NULL;
+static void* irq_handler_data = NULL;
+static int exceptions_enabled = 0;
+
+void Xil_ExceptionInit(void) {
+    irq_handler = NULL;
+    irq_handler_data = NULL;
+}
+
+void Xil_ExceptionRegisterHandler(u32 Exception_id, Xil_ExceptionHandler Handler, void* Data) {
+    if (Exception_id != XIL_EXCEPTION_ID_INT) return;
+
+    irq_handler = Handler;
+    irq_handler_data = Data;
+}
+
+static void dispatch_pending_interrupts(void);
+
+void Xil_ExceptionEnable(void) {
+    // Like unmasking IRQs on the core, anything raised while they were masked is taken now
+    sigset_t irq_mask, previous_mask;
+    sigemptyset(&irq_mask);
+    sigaddset(&irq_mask, SIGALRM);
+    sigprocmask(SIG_BLOCK, &irq_mask, &previous_mask);
+
+    exceptions_enabled = 1;
+    dispatch_pending_interrupts();
+
+    sigprocmask(SIG_SETMASK, &previous_mask, NULL);
+}
+
+void Xil_ExceptionDisable(void) {
+    exceptions_enabled = 0;
+}
+
+/*********************************** SCUGIC *********************************************/
+static XScuGic_Config gic_config = {XPAR_SCUGIC_SINGLE_DEVICE_ID, XPAR_SCUGIC_0_CPU_BASEADDR, XPAR_SCUGIC_0_DIST_BASEADDR};
+static u32 active_irq;
+static int in_interrupt = 0;
+static u8 pending_irq[XSCUGIC_MAX_NUM_INTR_INPUTS];
+
+XScuGic_Config* XScuGic_LookupConfig(u16 DeviceId) {
+    return (DeviceId == XPAR_SCUGIC_SINGLE_DEVICE_ID) ? &gic_config : NULL;
+}
+
+s32 XScuGic_CfgInitialize(XScuGic* InstancePtr, XScuGic_Config* ConfigPtr, u32 EffectiveAddr) {
+    (void)EffectiveAddr;
+
+    InstancePtr->Config = ConfigPtr;
+    for (int i = 0; i < XSCUGIC_MAX_NUM_INTR_INPUTS; i++) {
+        InstancePtr->HandlerTable[i].Handler = NULL;
+        InstancePtr->HandlerTable[i].CallBackRef = NULL;
+        InstancePtr->HandlerTable[i].Enabled = 0;
+    }
+    InstancePtr->IsReady = XIL_COMPONENT_IS_READY;
+
+    return XST_SUCCESS;
+}
+
+void XScuGic_SetPriorityTriggerType(XScuGic* InstancePtr, u32 Int_Id, u8 Priority, u8 Trigger) {
+    // Interrupts are delivered in the order they are raised, priorities are not modelled
+    (void)InstancePtr; (void)Int_Id; (void)Priority; (void)Trigger;
+}
+
+s32 XScuGic_Connect(XScuGic* InstancePtr, u32 Int_Id, Xil_InterruptHandler Handler, void* CallBackRef) {
+    if (Int_Id >= XSCUGIC_MAX_NUM_INTR_INPUTS) return XST_INVALID_PARAM;
+
+    InstancePtr->HandlerTable[Int_Id].Handler = Handler;
+    InstancePtr->HandlerTable[Int_Id].CallBackRef = CallBackRef;
+
+    return XST_SUCCESS;
+}
+
+void XScuGic_Disconnect(XScuGic* InstancePtr, u32 Int_Id) {
+    InstancePtr->HandlerTable[Int_Id].Handler = NULL;
+    InstancePtr->HandlerTable[Int_Id].CallBackRef = NULL;
+}
+
+void XScuGic_Enable(XScuGic* InstancePtr, u32 Int_Id) {
+    InstancePtr->HandlerTable[Int_Id].Enabled = 1;
+}
+
+void XScuGic_Disable(XScuGic* InstancePtr, u32 Int_Id) {
+    InstancePtr->HandlerTable[Int_Id].Enabled = 0;
+}
+
+void XScuGic_InterruptHandler(XScuGic* InstancePtr) {
+    XScuGic_VectorTableEntry* entry = &InstancePtr->HandlerTable[active_irq];
+
+    if (entry->Enabled && entry->Handler != NULL) entry->Handler(entry->CallBackRef);
+}
+
+static void dispatch_pending_interrupts(void) {
+    // IRQs are masked while a handler runs, the pending one is taken once it returns
+    if (in_interrupt || !exceptions_enabled || irq_handler == NULL) return;
+
+    in_interrupt = 1;
+    for (int serviced = 1; serviced; ) {
+        serviced = 0;
+        for (u32 id = 0; id < XSCUGIC_MAX_NUM_INTR_INPUTS; id++) {
+            if (!pending_irq[id]) continue;
+
+            pending_irq[id] = 0;
+            active_irq = id;
+            irq_handler(irq_handler_data);
+            serviced = 1;
+        }
+    }
+    in_interrupt = 0;
+}
+
+void host_raise_interrupt(u32 Int_Id) {
+    // SIGALRM (UART RX wire) plays an IRQ line, keep it out while pending_irq and the handlers are in use
+    sigset_t irq_mask, previous_mask;
+    sigemptyset(&irq_mask);
+    sigaddset(&irq_mask, SIGALRM);
+    sigprocmask(SIG_BLOCK, &irq_mask, &previous_mask);
+
+    pending_irq[Int_Id] = 1;
+    dispatch_pending_interrupts();
+
+    sigprocmask(SIG_SETMASK, &previous_mask, NULL);
+}
+
+/*********************************** AXI Timer *********************************************/
+static u64 now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (u64)ts.tv_sec*1000000000ULL + (u64)ts.tv_nsec;
+}
+
+static u64 elapsed_counts(XTmrCtr* InstancePtr, u8 TmrCtrNumber) {
+    u64 counts = InstancePtr->StoppedCount[TmrCtrNumber];
+
+    if (InstancePtr->IsRunning[TmrCtrNumber]) {
+        u64 elapsed_ns = now_ns() - InstancePtr->StartNs[TmrCtrNumber];
+        counts += (elapsed_ns * (InstancePtr->Config.SysClockFreqHz / 1000000)) / 1000;
+    }
+
+    return counts;
+}
+
+int XTmrCtr_Initialize(XTmrCtr* InstancePtr, u16 DeviceId) {
+    if (DeviceId != XPAR_TMRCTR_0_DEVICE_ID) return XST_DEVICE_NOT_FOUND;
+
+    InstancePtr->Config.DeviceId = DeviceId;
+    InstancePtr->Config.BaseAddress = XPAR_TMRCTR_0_BASEADDR;
+    InstancePtr->Config.SysClockFreqHz = XPAR_TMRCTR_0_CLOCK_FREQ_HZ;
+    for (int i = 0; i < XTC_DEVICE_TIMER_COUNT; i++) {
+        InstancePtr->Options[i] = 0;
+        InstancePtr->IsRunning[i] = 0;
+        InstancePtr->StoppedCount[i] = 0;
+        InstancePtr->ResetValue[i] = 0;
+    }
+    InstancePtr->IsReady = XIL_COMPONENT_IS_READY;
+
+    return XST_SUCCESS;
+}
+
+void XTmrCtr_SetOptions(XTmrCtr* InstancePtr, u8 TmrCtrNumber, u32 Options) {
+    InstancePtr->Options[TmrCtrNumber] = Options;
+}
+
+u32 XTmrCtr_GetOptions(XTmrCtr* InstancePtr, u8 TmrCtrNumber) {
+    return InstancePtr->Options[TmrCtrNumber];
+}
+
+void XTmrCtr_Start(XTmrCtr* InstancePtr, u8 TmrCtrNumber) {
+    // Like the hardware, starting loads the counter from TLR
+    InstancePtr->StoppedCount[TmrCtrNumber] = InstancePtr->ResetValue[TmrCtrNumber];
+    InstancePtr->StartNs[TmrCtrNumber] = now_ns();
+    InstancePtr->IsRunning[TmrCtrNumber] = 1;
+}
+
+void XTmrCtr_Stop(XTmrCtr* InstancePtr, u8 TmrCtrNumber) {
+    InstancePtr->StoppedCount[TmrCtrNumber] = elapsed_counts(InstancePtr, TmrCtrNumber);
+    InstancePtr->IsRunning[TmrCtrNumber] = 0;
+}
+
+void XTmrCtr_Reset(XTmrCtr* InstancePtr, u8 TmrCtrNumber) {
+    InstancePtr->StoppedCount[TmrCtrNumber] = InstancePtr->ResetValue[TmrCtrNumber];
+    InstancePtr->StartNs[TmrCtrNumber] = now_ns();
+}
+
+void XTmrCtr_SetResetValue(XTmrCtr* InstancePtr, u8 TmrCtrNumber, u32 ResetValue) {
+    InstancePtr->ResetValue[TmrCtrNumber] = ResetValue;
+}
+
+u32 XTmrCtr_GetValue(XTmrCtr* InstancePtr, u8 TmrCtrNumber) {
+    #ifdef HOST_TMRCTR_ONE_TIMER_ONLY
+        // Like wrapper.xsa, the AXI-Timer was built without Timer 2, its registers read as 0
+        if (TmrCtrNumber == 1) return 0;
+    #endif
+
+    // Cascade mode: Timer0 drives both, TCR1 holds the upper word of the 64-bit count
+    if (TmrCtrNumber == 1 && (InstancePtr->Options[0] & XTC_CASCADE_MODE_OPTION)) {
+        return (u32)(elapsed_counts(InstancePtr, 0) >> 32);
+    }
+
+    return (u32)elapsed_counts(InstancePtr, TmrCtrNumber);
+}
+
+/*********************************** Global timer *********************************************/
+void XTime_GetTime(XTime* Xtime_Global) {
+    *Xtime_Global = (now_ns() * (COUNTS_PER_SECOND / 1000000)) / 1000;
+}
\ No newline at end of file
@@ -0,0 +1,223 @@
+// Host emulation of the UART PS driver
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "xparameters.h"
+#include "xuartps.h"
+#include "xscugic.h"
+
+#define HOST_UART_DEFAULT_INPUT "uart_input.csv"
+#define HOST_UART_TICK_US       1000    // Wire model granularity
+#define HOST_UART_BITS_PER_BYTE 10      // 8N1
+#define HOST_UART_IDLE_EXIT_NS  5000000000ULL   // Idle line after the end of the input, longer than FRAME_LINGER_US
+#define HOST_UART_RX_INTERRUPTS (XUARTPS_IXR_RXOVR | XUARTPS_IXR_RXFULL | XUARTPS_IXR_OVER | XUARTPS_IXR_TOUT)
+
+static XUartPs_Config uart_config = {XPAR_XUARTPS_0_DEVICE_ID, XPAR_XUARTPS_0_BASEADDR, XPAR_XUARTPS_0_UART_CLK_FREQ_HZ};
+static FILE* uart_input = NULL;
+static u32 uart_baud_rate = 115200;
+
+// Wire model, only once RX interrupts are enabled. Everything below is touched with SIGALRM blocked (handler, ISR, mask updates)
+static u32 interrupt_mask = 0;
+static u32 interrupt_status = 0;
+static u8 fifo_threshold = 32;
+static u8 rx_fifo[XUARTPS_FIFO_DEPTH];
+static int rx_fifo_head = 0;
+static int rx_fifo_level = 0;
+static u64 wire_start_ns;
+static u64 wire_bytes = 0;
+static int wire_done = 0;
+static u64 idle_since_ns = 0;
+
+static FILE* open_uart_input(void) {
+    if (uart_input != NULL) return uart_input;
+
+    const char* path = getenv("UART_INPUT_FILE");
+    if (path == NULL) path = HOST_UART_DEFAULT_INPUT;
+
+    uart_input = fopen(path, "rb");
+    if (uart_input == NULL) {
+        fprintf(stderr, "host: cannot open UART input file %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    return uart_input;
+}
+
+XUartPs_Config* XUartPs_LookupConfig(u16 DeviceId) {
+    return (DeviceId == XPAR_XUARTPS_0_DEVICE_ID) ? &uart_config : NULL;
+}
+
+s32 XUartPs_CfgInitialize(XUartPs* InstancePtr, XUartPs_Config* Config, UINTPTR EffectiveAddr) {
+    InstancePtr->Config = *Config;
+    InstancePtr->Config.BaseAddress = EffectiveAddr;
+    InstancePtr->BaudRate = 115200;
+    InstancePtr->IsReady = XIL_COMPONENT_IS_READY;
+
+    return XST_SUCCESS;
+}
+
+s32 XUartPs_SetBaudRate(XUartPs* InstancePtr, u32 BaudRate) {
+    // No wire, so the baud rate has no effect on timing
+    InstancePtr->BaudRate = BaudRate;
+    uart_baud_rate = BaudRate;
+
+    return XST_SUCCESS;
+}
+
+static u64 now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (u64)ts.tv_sec*1000000000ULL + (u64)ts.tv_nsec;
+}
+
+static void stop_wire(void) {
+    struct itimerval timer = {{0, 0}, {0, 0}};
+    setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+static void wire_tick(int signal_number) {
+    (void)signal_number;
+
+    // Bytes which made it through the wire since the last tick go into the RX FIFO
+    u64 arrived = ((now_ns() - wire_start_ns) * uart_baud_rate) / (HOST_UART_BITS_PER_BYTE * 1000000000ULL);
+    int new_bytes = 0;
+
+    // A late tick (host scheduling) would overrun the FIFO, which the board never sees, the rest waits for the next tick
+    while (!wire_done && wire_bytes < arrived && rx_fifo_level < XUARTPS_FIFO_DEPTH) {
+        int c = fgetc(open_uart_input());
+        if (c == EOF) {
+            wire_done = 1;
+            break;
+        }
+        wire_bytes++;
+        new_bytes++;
+
+        rx_fifo[(rx_fifo_head + rx_fifo_level) % XUARTPS_FIFO_DEPTH] = (u8)c;
+        rx_fifo_level++;
+    }
+
+    if (rx_fifo_level >= fifo_threshold) interrupt_status |= XUARTPS_IXR_RXOVR;
+    if (rx_fifo_level > 0 && new_bytes == 0) interrupt_status |= XUARTPS_IXR_TOUT;
+    if (rx_fifo_level == XUARTPS_FIFO_DEPTH) interrupt_status |= XUARTPS_IXR_RXFULL;
+
+    // Level sensitive, raised again on every tick until the ISR has cleared it
+    if (interrupt_status & interrupt_mask) host_raise_interrupt(XPAR_XUARTPS_0_INTR);
+
+    if (wire_done && rx_fifo_level == 0) stop_wire();
+}
+
+static void start_wire(u32 previous_mask);
+
+static void update_interrupts(u32 previous_mask, u32 new_mask) {
+    sigset_t irq_mask, previous_sigmask;
+    sigemptyset(&irq_mask);
+    sigaddset(&irq_mask, SIGALRM);
+    sigprocmask(SIG_BLOCK, &irq_mask, &previous_sigmask);
+
+    interrupt_mask = new_mask;
+    start_wire(previous_mask);
+
+    // TX FIFO is always empty, so TXEMPTY fires as soon as it is enabled
+    interrupt_status |= XUARTPS_IXR_TXEMPTY;
+    sigprocmask(SIG_SETMASK, &previous_sigmask, NULL);
+
+    if (interrupt_status & interrupt_mask & XUARTPS_IXR_TXEMPTY) host_raise_interrupt(XPAR_XUARTPS_0_INTR);
+}
+
+static void start_wire(u32 previous_mask) {
+    if ((previous_mask & HOST_UART_RX_INTERRUPTS) || !(interrupt_mask & HOST_UART_RX_INTERRUPTS)) return;
+
+    // The sender starts right away, the file goes out at the baud rate from now on
+    struct sigaction action = {0};
+    action.sa_handler = wire_tick;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGALRM, &action, NULL);
+
+    wire_start_ns = now_ns();
+    struct itimerval timer = {{0, HOST_UART_TICK_US}, {0, HOST_UART_TICK_US}};
+    setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+void XUartPs_SetInterruptMask(XUartPs* InstancePtr, u32 Mask) {
+    (void)InstancePtr;
+    update_interrupts(interrupt_mask, Mask);
+}
+
+void XUartPs_SetFifoThreshold(XUartPs* InstancePtr, u8 TriggerLevel) {
+    (void)InstancePtr;
+    fifo_threshold = TriggerLevel;
+}
+
+void XUartPs_SetRecvTimeout(XUartPs* InstancePtr, u8 RecvTimeout) {
+    // Timeout is one tick without a new byte
+    (void)InstancePtr; (void)RecvTimeout;
+}
+
+u32 host_uart_rx_ready(void) {
+    if (interrupt_mask & HOST_UART_RX_INTERRUPTS) return rx_fifo_level > 0;
+
+    FILE* input = open_uart_input();
+    int c = fgetc(input);
+
+    // Nothing will ever arrive again, an idle line for a while (receive_frames lingers) but a board would spin forever past that
+    if (c == EOF) {
+        if (idle_since_ns == 0) idle_since_ns = now_ns();
+        if (now_ns() - idle_since_ns > HOST_UART_IDLE_EXIT_NS) {
+            fprintf(stderr, "host: UART input exhausted\n");
+            exit(EXIT_FAILURE);
+        }
+        return FALSE;
+    }
+
+    ungetc(c, input);
+    return TRUE;
+}
+
+u32 host_uart_read_reg(u32 RegOffset) {
+    switch (RegOffset) {
+    case XUARTPS_FIFO_OFFSET:
+        if (interrupt_mask & HOST_UART_RX_INTERRUPTS) {
+            if (rx_fifo_level == 0) return 0;
+
+            u8 data = rx_fifo[rx_fifo_head];
+            rx_fifo_head = (rx_fifo_head + 1) % XUARTPS_FIFO_DEPTH;
+            rx_fifo_level--;
+            return data;
+        }
+        else {
+            int c = fgetc(open_uart_input());
+            return (c == EOF) ? 0 : (u32)c;
+        }
+    case XUARTPS_ISR_OFFSET:
+        return interrupt_status;
+    case XUARTPS_IMR_OFFSET:
+        return interrupt_mask;
+    default:
+        return 0;
+    }
+}
+
+void host_uart_write_reg(u32 RegOffset, u32 Data) {
+    switch (RegOffset) {
+    case XUARTPS_FIFO_OFFSET:
+        putchar((int)(Data & 0xFF));
+        break;
+    case XUARTPS_ISR_OFFSET:
+        // Write 1 to clear
+        interrupt_status &= ~Data;
+        break;
+    case XUARTPS_IER_OFFSET:
+        update_interrupts(interrupt_mask, interrupt_mask | Data);
+        break;
+    case XUARTPS_IDR_OFFSET:
+        update_interrupts(interrupt_mask, interrupt_mask & ~Data);
+        break;
+    default:
+        break;
+    }
+}
\ No newline at end of file
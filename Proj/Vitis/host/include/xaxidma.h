@@ -0,0 +1,151 @@
+// Host emulation of the AXI DMA driver, direct register (simple) and scatter-gather mode
+// MM2S transfers are handed to the C++ coprocessor model as one transaction, S2MM transfers complete once the model has streamed out a packet
+// In scatter-gather mode, MM2S BDs are gathered up to TXEOF into one transaction, S2MM BDs are filled packet by packet
+#ifndef XAXIDMA_H
+#define XAXIDMA_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+#include "xparameters.h"
+
+#define XAXIDMA_DMA_TO_DEVICE   0x00
+#define XAXIDMA_DEVICE_TO_DMA   0x01
+
+#define XAXIDMA_IRQ_IOC_MASK    0x00001000
+#define XAXIDMA_IRQ_DELAY_MASK  0x00002000
+#define XAXIDMA_IRQ_ERROR_MASK  0x00004000
+#define XAXIDMA_IRQ_ALL_MASK    0x00007000
+
+#define XAXIDMA_BD_MINIMUM_ALIGNMENT    0x40
+#define XAXIDMA_BD_CTRL_TXSOF_MASK      0x08000000
+#define XAXIDMA_BD_CTRL_TXEOF_MASK      0x04000000
+#define XAXIDMA_BD_CTRL_ALL_MASK        0x0C000000
+#define XAXIDMA_BD_STS_COMPLETE_MASK    0x80000000
+#define XAXIDMA_BD_STS_DEC_ERR_MASK     0x40000000
+#define XAXIDMA_BD_STS_SLV_ERR_MASK     0x20000000
+#define XAXIDMA_BD_STS_INT_ERR_MASK     0x10000000
+#define XAXIDMA_BD_STS_ALL_ERR_MASK     0x70000000
+#define XAXIDMA_BD_STS_RXSOF_MASK       0x08000000
+#define XAXIDMA_BD_STS_RXEOF_MASK       0x04000000
+#define XAXIDMA_ALL_BDS                 0x0FFFFFFF
+
+// Same size and alignment as the hardware descriptor
+typedef struct {
+    UINTPTR NextDesc;
+    UINTPTR BufAddr;
+    u32 Control;        // Buffer length and TXSOF/TXEOF
+    u32 Status;         // Transferred length, COMPLETE, RXSOF/RXEOF
+    UINTPTR Id;
+    u32 Reserved[6];
+} __attribute__ ((aligned (XAXIDMA_BD_MINIMUM_ALIGNMENT))) XAxiDma_Bd;
+
+// BDs move Free -> Pre (Alloc) -> Hw (ToHw) -> Post (FromHw) -> Free (Free), always in ring order
+typedef struct {
+    XAxiDma_Bd* FirstBd;
+    int AllCnt;
+    int FreeHead, FreeCnt;
+    int PreHead, PreCnt;
+    int HwHead, HwCnt;
+    int PostHead, PostCnt;
+    int HwCursor;       // Next Hw BD the (emulated) engine works on
+    int HwPending;      // Hw BDs the engine has not processed yet
+    int RunState;
+    int IsRxChannel;
+    u32 MaxTransferLen;
+} XAxiDma_BdRing;
+
+typedef struct {
+    u32 DeviceId;
+    UINTPTR BaseAddr;
+    int HasStsCntrlStrm;
+    int HasMm2S;
+    int HasMm2SDRE;
+    int Mm2SDataWidth;
+    int HasS2Mm;
+    int HasS2MmDRE;
+    int S2MmDataWidth;
+    int HasSg;
+    int Mm2sNumChannels;
+    int S2MmNumChannels;
+    int Mm2SBurstSize;
+    int S2MmBurstSize;
+    int MicroDmaMode;
+    int AddrWidth;
+    int SgLengthWidth;
+} XAxiDma_Config;
+
+// Per direction channel state
+typedef struct {
+    u32 IntrMask;       // Enabled interrupts
+    u32 IntrStatus;     // Raised interrupts, acknowledged with XAxiDma_IntrAckIrq
+    int Busy;
+    UINTPTR BuffAddr;
+    u32 Length;
+} XAxiDma_Channel;
+
+typedef struct {
+    UINTPTR RegBase;
+    int HasMm2S;
+    int HasS2Mm;
+    int Initialized;
+    int HasSg;
+    XAxiDma_Channel Channel[2];     // Indexed by XAXIDMA_DMA_TO_DEVICE / XAXIDMA_DEVICE_TO_DMA
+    XAxiDma_BdRing TxBdRing;
+    XAxiDma_BdRing RxBdRing[1];
+} XAxiDma;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+XAxiDma_Config* XAxiDma_LookupConfig(u32 DeviceId);
+int XAxiDma_CfgInitialize(XAxiDma* InstancePtr, XAxiDma_Config* Config);
+void XAxiDma_Reset(XAxiDma* InstancePtr);
+int XAxiDma_ResetIsDone(XAxiDma* InstancePtr);
+u32 XAxiDma_SimpleTransfer(XAxiDma* InstancePtr, UINTPTR BuffAddr, u32 Length, int Direction);
+u32 XAxiDma_Busy(XAxiDma* InstancePtr, int Direction);
+
+void XAxiDma_IntrEnable(XAxiDma* InstancePtr, u32 Mask, int Direction);
+void XAxiDma_IntrDisable(XAxiDma* InstancePtr, u32 Mask, int Direction);
+u32 XAxiDma_IntrGetIrq(XAxiDma* InstancePtr, int Direction);
+void XAxiDma_IntrAckIrq(XAxiDma* InstancePtr, u32 Mask, int Direction);
+
+u32 XAxiDma_BdRingCntCalc(u32 Alignment, u32 Bytes);
+int XAxiDma_BdRingCreate(XAxiDma_BdRing* RingPtr, UINTPTR PhysAddr, UINTPTR VirtAddr, u32 Alignment, int BdCount);
+int XAxiDma_BdRingClone(XAxiDma_BdRing* RingPtr, XAxiDma_Bd* SrcBdPtr);
+int XAxiDma_BdRingStart(XAxiDma_BdRing* RingPtr);
+int XAxiDma_BdRingAlloc(XAxiDma_BdRing* RingPtr, int NumBd, XAxiDma_Bd** BdSetPtr);
+int XAxiDma_BdRingUnAlloc(XAxiDma_BdRing* RingPtr, int NumBd, XAxiDma_Bd* BdSetPtr);
+int XAxiDma_BdRingToHw(XAxiDma_BdRing* RingPtr, int NumBd, XAxiDma_Bd* BdSetPtr);
+int XAxiDma_BdRingFromHw(XAxiDma_BdRing* RingPtr, int BdLimit, XAxiDma_Bd** BdSetPtr);
+int XAxiDma_BdRingFree(XAxiDma_BdRing* RingPtr, int NumBd, XAxiDma_Bd* BdSetPtr);
+XAxiDma_Bd* XAxiDma_BdRingNext(XAxiDma_BdRing* RingPtr, XAxiDma_Bd* BdPtr);
+void XAxiDma_BdRingIntEnable(XAxiDma_BdRing* RingPtr, u32 Mask);
+void XAxiDma_BdRingIntDisable(XAxiDma_BdRing* RingPtr, u32 Mask);
+u32 XAxiDma_BdRingGetIrq(XAxiDma_BdRing* RingPtr);
+void XAxiDma_BdRingAckIrq(XAxiDma_BdRing* RingPtr, u32 Mask);
+
+void XAxiDma_BdClear(XAxiDma_Bd* BdPtr);
+int XAxiDma_BdSetBufAddr(XAxiDma_Bd* BdPtr, UINTPTR Addr);
+int XAxiDma_BdSetLength(XAxiDma_Bd* BdPtr, u32 LenBytes, u32 LengthMask);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define XAxiDma_GetTxRing(InstancePtr)              (&((InstancePtr)->TxBdRing))
+#define XAxiDma_GetRxRing(InstancePtr)              (&((InstancePtr)->RxBdRing[0]))
+#define XAxiDma_BdRingGetFreeCnt(RingPtr)           ((RingPtr)->FreeCnt)
+#define XAxiDma_BdRingGetCnt(RingPtr)               ((RingPtr)->AllCnt)
+#define XAxiDma_BdSetCtrl(BdPtr, Data)              ((BdPtr)->Control = ((BdPtr)->Control & ~XAXIDMA_BD_CTRL_ALL_MASK) | ((Data) & XAXIDMA_BD_CTRL_ALL_MASK))
+#define XAxiDma_BdGetCtrl(BdPtr)                    ((BdPtr)->Control & XAXIDMA_BD_CTRL_ALL_MASK)
+#define XAxiDma_BdGetSts(BdPtr)                     ((BdPtr)->Status)
+#define XAxiDma_BdGetLength(BdPtr, LengthMask)      ((BdPtr)->Control & (LengthMask))
+#define XAxiDma_BdGetActualLength(BdPtr, LengthMask) ((BdPtr)->Status & (LengthMask))
+#define XAxiDma_BdGetBufAddr(BdPtr)                 ((BdPtr)->BufAddr)
+#define XAxiDma_BdSetId(BdPtr, IdValue)             ((BdPtr)->Id = (UINTPTR)(IdValue))
+#define XAxiDma_BdGetId(BdPtr)                      ((BdPtr)->Id)
+
+#define XAxiDma_HasSg(InstancePtr)  (((InstancePtr)->HasSg) ? TRUE : FALSE)
+
+#endif
\ No newline at end of file
@@ -0,0 +1,13 @@
+// Host emulation of the cache maintenance API
+// Emulated DMA reads and writes host memory directly, so maintenance operations are no-ops
+#ifndef XIL_CACHE_H
+#define XIL_CACHE_H
+
+#include "xil_types.h"
+
+#define Xil_DCacheFlushRange(adr, len)      ((void)(adr), (void)(len))
+#define Xil_DCacheInvalidateRange(adr, len) ((void)(adr), (void)(len))
+#define Xil_DCacheEnable()
+#define Xil_DCacheDisable()
+
+#endif
\ No newline at end of file
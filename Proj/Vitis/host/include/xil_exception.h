@@ -0,0 +1,25 @@
+// Host emulation of the A53 exception table
+#ifndef XIL_EXCEPTION_H
+#define XIL_EXCEPTION_H
+
+#include "xil_types.h"
+
+#define XIL_EXCEPTION_ID_INT    5U
+
+typedef void (*Xil_ExceptionHandler)(void* data);
+typedef void (*Xil_InterruptHandler)(void* data);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void Xil_ExceptionInit(void);
+void Xil_ExceptionRegisterHandler(u32 Exception_id, Xil_ExceptionHandler Handler, void* Data);
+void Xil_ExceptionEnable(void);
+void Xil_ExceptionDisable(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
\ No newline at end of file
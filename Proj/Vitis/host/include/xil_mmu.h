@@ -0,0 +1,15 @@
+// Host emulation of the MMU attribute API
+// Host memory is always coherent with the emulated DMA, so attributes are accepted and ignored
+#ifndef XIL_MMU_H
+#define XIL_MMU_H
+
+#include "xil_types.h"
+
+#define NORM_NONCACHE   0x401UL     // Normal non-cacheable
+#define STRONG_ORDERED  0x409UL
+#define DEVICE_MEMORY   0x40DUL
+#define NORM_WB_CACHE   0x705UL     // Normal write-back cacheable
+
+#define Xil_SetTlbAttributes(Addr, attrib)  ((void)(Addr), (void)(attrib))
+
+#endif
\ No newline at end of file
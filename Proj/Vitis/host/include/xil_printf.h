@@ -0,0 +1,17 @@
+// Host emulation of xil_printf, output goes to stdout
+#ifndef XIL_PRINTF_H
+#define XIL_PRINTF_H
+
+#include "xil_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void xil_printf(const char* ctrl1, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
\ No newline at end of file
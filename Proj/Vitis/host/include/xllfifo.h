@@ -0,0 +1,78 @@
+// Host emulation of the AXI-Stream FIFO (AXI_FIFO_MM_S) driver
+// TX packets are handed to the C++ coprocessor model when their length is written, RX packets are whatever the model streamed out
+#ifndef XLLFIFO_H
+#define XLLFIFO_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+#include "xparameters.h"
+
+#define XLLF_INT_RPURE_MASK     0x80000000
+#define XLLF_INT_RPORE_MASK     0x40000000
+#define XLLF_INT_RPUE_MASK      0x20000000
+#define XLLF_INT_TPOE_MASK      0x10000000
+#define XLLF_INT_TC_MASK        0x08000000
+#define XLLF_INT_RC_MASK        0x04000000
+#define XLLF_INT_TSE_MASK       0x02000000
+#define XLLF_INT_TRC_MASK       0x01000000
+#define XLLF_INT_RRC_MASK       0x00800000
+#define XLLF_INT_TFPF_MASK      0x00400000
+#define XLLF_INT_TFPE_MASK      0x00200000
+#define XLLF_INT_RFPF_MASK      0x00100000
+#define XLLF_INT_RFPE_MASK      0x00080000
+#define XLLF_INT_ALL_MASK       0xfff80000
+#define XLLF_INT_ERROR_MASK     0xf2000000
+
+typedef struct {
+    u32 DeviceId;
+    UINTPTR BaseAddress;
+    UINTPTR Axi4BaseAddress;
+    u32 Datainterface;
+} XLlFifo_Config;
+
+typedef struct {
+    UINTPTR BaseAddress;
+    u32 IsReady;
+    u32 Isr;                // Interrupt Status Register
+    u32 Ier;                // Interrupt Enable Register
+    u32 TxCount;            // Words written into TX FIFO but not yet sent
+    u32 TxBuffer[XPAR_AXI_FIFO_0_TX_FIFO_DEPTH];
+    u32 RxRemaining;        // Words left in the packet currently being read
+} XLlFifo;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+XLlFifo_Config* XLlFfio_LookupConfig(u32 DeviceId);
+int XLlFifo_CfgInitialize(XLlFifo* InstancePtr, XLlFifo_Config* Config, UINTPTR EffectiveAddress);
+
+u32 XLlFifo_Status(XLlFifo* InstancePtr);
+void XLlFifo_IntClear(XLlFifo* InstancePtr, u32 Mask);
+void XLlFifo_IntEnable(XLlFifo* InstancePtr, u32 Mask);
+void XLlFifo_IntDisable(XLlFifo* InstancePtr, u32 Mask);
+u32 XLlFifo_IntPending(XLlFifo* InstancePtr);
+
+u32 XLlFifo_iTxVacancy(XLlFifo* InstancePtr);
+void XLlFifo_TxPutWord(XLlFifo* InstancePtr, u32 Word);
+void XLlFifo_iTxSetLen(XLlFifo* InstancePtr, u32 Bytes);
+int XLlFifo_Write(XLlFifo* InstancePtr, void* BufPtr, u32 Bytes);
+
+u32 XLlFifo_iRxOccupancy(XLlFifo* InstancePtr);
+u32 XLlFifo_iRxGetLen(XLlFifo* InstancePtr);
+u32 XLlFifo_RxGetWord(XLlFifo* InstancePtr);
+int XLlFifo_Read(XLlFifo* InstancePtr, void* BufPtr, u32 Bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define XLlFifo_LookupConfig            XLlFfio_LookupConfig
+#define XLlFifo_TxVacancy               XLlFifo_iTxVacancy
+#define XLlFifo_TxSetLen                XLlFifo_iTxSetLen
+#define XLlFifo_RxOccupancy             XLlFifo_iRxOccupancy
+#define XLlFifo_RxGetLen                XLlFifo_iRxGetLen
+#define XLlFifo_IsTxDone(InstancePtr)   ((XLlFifo_Status(InstancePtr) & XLLF_INT_TC_MASK) ? TRUE : FALSE)
+#define XLlFifo_IsRxDone(InstancePtr)   ((XLlFifo_Status(InstancePtr) & XLLF_INT_RC_MASK) ? TRUE : FALSE)
+
+#endif
\ No newline at end of file
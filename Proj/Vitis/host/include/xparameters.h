@@ -0,0 +1,62 @@
+// Host emulation of the BSP generated xparameters.h
+// Only the peripherals present in our block design (wrapper.xsa) are listed
+#ifndef XPARAMETERS_H
+#define XPARAMETERS_H
+
+#include "xil_types.h"
+
+// Zynq MPSoC APU
+#define XPAR_CPU_CORTEXA53_0_CPU_CLK_FREQ_HZ    1199988037
+#define XPAR_CPU_CORES_NUM                      4
+#define XPAR_CPU_CORTEXA53_0_TIMESTAMP_CLK_FREQ 99999001
+
+// OCM, shared by the cores, emulated by an array of host_cores.c
+#ifdef __cplusplus
+extern "C" u8 host_ocm[];
+#else
+extern u8 host_ocm[];
+#endif
+#define XPAR_PSU_OCM_RAM_0_S_AXI_BASEADDR       ((UINTPTR)host_ocm)
+#define XPAR_PSU_OCM_RAM_0_S_AXI_HIGHADDR       (XPAR_PSU_OCM_RAM_0_S_AXI_BASEADDR + 0x3FFFF)
+
+// UART0
+#define XPAR_XUARTPS_0_DEVICE_ID        0
+#define XPAR_XUARTPS_0_BASEADDR         0xFF000000
+#define XPAR_XUARTPS_0_UART_CLK_FREQ_HZ 99999001
+#define XPAR_XUARTPS_0_INTR             53
+
+// SCUGIC
+#define XPAR_SCUGIC_SINGLE_DEVICE_ID    0
+#define XPAR_SCUGIC_0_CPU_BASEADDR      0xF9020000
+#define XPAR_SCUGIC_0_DIST_BASEADDR     0xF9010000
+
+// AXI_FIFO_MM_S_0
+#define XPAR_AXI_FIFO_0_DEVICE_ID       0
+#define XPAR_AXI_FIFO_0_BASEADDR        0xA0000000
+// Must hold a whole batch, AXIS_transmit sends it as one packet (axi_stream.h checks this)
+#ifndef XPAR_AXI_FIFO_0_TX_FIFO_DEPTH
+#define XPAR_AXI_FIFO_0_TX_FIFO_DEPTH   1024
+#endif
+#define XPAR_AXI_FIFO_0_RX_FIFO_DEPTH   1024
+#define XPAR_FABRIC_LLFIFO_0_VEC_ID     121
+
+// AXI_DMA_0
+#define XPAR_AXIDMA_0_DEVICE_ID             0
+#define XPAR_AXIDMA_0_BASEADDR              0xA0010000
+// Set to 1 (make EXTRA_CFLAGS=-DAXI_DMA_SG_MODE does it) to emulate the bitstream with scatter-gather enabled
+#ifndef XPAR_AXIDMA_0_INCLUDE_SG
+#define XPAR_AXIDMA_0_INCLUDE_SG            0
+#endif
+#define XPAR_FABRIC_AXIDMA_0_MM2S_INTROUT_VEC_ID   123
+#define XPAR_FABRIC_AXIDMA_0_S2MM_INTROUT_VEC_ID   124
+
+// AXI_TIMER_0
+#define XPAR_TMRCTR_0_DEVICE_ID         0
+#define XPAR_TMRCTR_0_BASEADDR          0xA0020000
+#define XPAR_TMRCTR_0_CLOCK_FREQ_HZ     99999001
+#define XPAR_FABRIC_TMRCTR_0_VEC_ID     122
+
+// DDR
+#define XPAR_PSU_DDR_0_S_AXI_BASEADDR   0x00000000
+
+#endif
\ No newline at end of file
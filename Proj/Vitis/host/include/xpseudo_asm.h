@@ -0,0 +1,25 @@
+// Host emulation of the A53 inline assembly macros
+// Interrupts of core 0 are delivered by the models (or SIGALRM) as soon as they are raised, waiting for one is just a spin
+// WFE/SEV wake the other cores (threads of host_cores.c), barriers are full memory barriers
+#ifndef XPSEUDO_ASM_H
+#define XPSEUDO_ASM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void host_wfe(void);
+void host_sev(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define wfi()
+#define wfe()   host_wfe()
+#define sev()   host_sev()
+#define dsb()   __sync_synchronize()
+#define dmb()   __sync_synchronize()
+#define isb()   __sync_synchronize()
+
+#endif
\ No newline at end of file
@@ -0,0 +1,49 @@
+// Host emulation of the SCUGIC driver
+// Interrupts are raised by the emulated peripherals through host_raise_interrupt(), and the connected handler is called in place
+#ifndef XSCUGIC_H
+#define XSCUGIC_H
+
+#include "xil_types.h"
+#include "xil_exception.h"
+
+#define XSCUGIC_MAX_NUM_INTR_INPUTS 195
+
+typedef struct {
+    u16 DeviceId;
+    UINTPTR CpuBaseAddress;
+    UINTPTR DistBaseAddress;
+} XScuGic_Config;
+
+typedef struct {
+    Xil_InterruptHandler Handler;
+    void* CallBackRef;
+    u8 Enabled;
+} XScuGic_VectorTableEntry;
+
+typedef struct {
+    XScuGic_Config* Config;
+    u32 IsReady;
+    XScuGic_VectorTableEntry HandlerTable[XSCUGIC_MAX_NUM_INTR_INPUTS];
+} XScuGic;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+XScuGic_Config* XScuGic_LookupConfig(u16 DeviceId);
+s32 XScuGic_CfgInitialize(XScuGic* InstancePtr, XScuGic_Config* ConfigPtr, u32 EffectiveAddr);
+void XScuGic_SetPriorityTriggerType(XScuGic* InstancePtr, u32 Int_Id, u8 Priority, u8 Trigger);
+s32 XScuGic_Connect(XScuGic* InstancePtr, u32 Int_Id, Xil_InterruptHandler Handler, void* CallBackRef);
+void XScuGic_Disconnect(XScuGic* InstancePtr, u32 Int_Id);
+void XScuGic_Enable(XScuGic* InstancePtr, u32 Int_Id);
+void XScuGic_Disable(XScuGic* InstancePtr, u32 Int_Id);
+void XScuGic_InterruptHandler(XScuGic* InstancePtr);
+
+// Host only: deliver interrupt Int_Id to its handler, if connected, enabled and exceptions are enabled
+void host_raise_interrupt(u32 Int_Id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
\ No newline at end of file
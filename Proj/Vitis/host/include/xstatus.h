@@ -0,0 +1,15 @@
+// Host emulation of the standalone BSP status codes
+#ifndef XSTATUS_H
+#define XSTATUS_H
+
+#include "xil_types.h"
+
+#define XST_SUCCESS             0L
+#define XST_FAILURE             1L
+#define XST_DEVICE_NOT_FOUND    2L
+#define XST_INVALID_PARAM       15L
+#define XST_DEVICE_BUSY         21L
+#define XST_DMA_SG_NO_LIST      523L
+#define XST_DMA_SG_LIST_ERROR   526L
+
+#endif
\ No newline at end of file
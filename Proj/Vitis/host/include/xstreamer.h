@@ -0,0 +1,7 @@
+// Host emulation of the streamer layer used by the LLFIFO driver
+#ifndef XSTREAMER_H
+#define XSTREAMER_H
+
+#include "xil_types.h"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,22 @@
+// Host emulation of the A53 global timer (generic timer counter, shared by all cores)
+#ifndef XTIME_L_H
+#define XTIME_L_H
+
+#include "xil_types.h"
+#include "xparameters.h"
+
+typedef u64 XTime;
+
+#define COUNTS_PER_SECOND   XPAR_CPU_CORTEXA53_0_TIMESTAMP_CLK_FREQ
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void XTime_GetTime(XTime* Xtime_Global);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
\ No newline at end of file
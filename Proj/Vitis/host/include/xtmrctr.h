@@ -0,0 +1,52 @@
+// Host emulation of the AXI Timer driver
+// Counters tick at XPAR_TMRCTR_0_CLOCK_FREQ_HZ, derived from clock_gettime(CLOCK_MONOTONIC)
+#ifndef XTMRCTR_H
+#define XTMRCTR_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+#define XTC_DEVICE_TIMER_COUNT      2
+
+#define XTC_CASCADE_MODE_OPTION     0x00000080UL
+#define XTC_ENABLE_ALL_OPTION       0x00000040UL
+#define XTC_DOWN_COUNT_OPTION       0x00000020UL
+#define XTC_CAPTURE_MODE_OPTION     0x00000010UL
+#define XTC_INT_MODE_OPTION         0x00000008UL
+#define XTC_AUTO_RELOAD_OPTION      0x00000004UL
+#define XTC_EXT_COMPARE_OPTION      0x00000002UL
+
+typedef struct {
+    u16 DeviceId;
+    UINTPTR BaseAddress;
+    u32 SysClockFreqHz;
+} XTmrCtr_Config;
+
+typedef struct {
+    XTmrCtr_Config Config;
+    u32 IsReady;
+    u32 Options[XTC_DEVICE_TIMER_COUNT];
+    u32 IsRunning[XTC_DEVICE_TIMER_COUNT];
+    u64 StartNs[XTC_DEVICE_TIMER_COUNT];
+    u64 StoppedCount[XTC_DEVICE_TIMER_COUNT];
+    u32 ResetValue[XTC_DEVICE_TIMER_COUNT];
+} XTmrCtr;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int XTmrCtr_Initialize(XTmrCtr* InstancePtr, u16 DeviceId);
+void XTmrCtr_SetOptions(XTmrCtr* InstancePtr, u8 TmrCtrNumber, u32 Options);
+u32 XTmrCtr_GetOptions(XTmrCtr* InstancePtr, u8 TmrCtrNumber);
+void XTmrCtr_Start(XTmrCtr* InstancePtr, u8 TmrCtrNumber);
+void XTmrCtr_Stop(XTmrCtr* InstancePtr, u8 TmrCtrNumber);
+void XTmrCtr_Reset(XTmrCtr* InstancePtr, u8 TmrCtrNumber);
+void XTmrCtr_SetResetValue(XTmrCtr* InstancePtr, u8 TmrCtrNumber, u32 ResetValue);
+u32 XTmrCtr_GetValue(XTmrCtr* InstancePtr, u8 TmrCtrNumber);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,62 @@
+// Host emulation of the UART PS driver
+// RX is fed from the file named by the UART_INPUT_FILE environment variable (uart_input.csv by default), TX goes to stdout
+// Once RX interrupts are enabled, bytes arrive at the baud rate into a 64 byte RX FIFO, paced by SIGALRM which plays the IRQ line
+// TX is infinitely fast, the TX FIFO is always empty
+#ifndef XUARTPS_H
+#define XUARTPS_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+#define XUARTPS_FIFO_OFFSET     0x0030U
+#define XUARTPS_SR_OFFSET       0x002CU
+#define XUARTPS_IER_OFFSET      0x0008U
+#define XUARTPS_IDR_OFFSET      0x000CU
+#define XUARTPS_IMR_OFFSET      0x0010U
+#define XUARTPS_ISR_OFFSET      0x0014U
+
+#define XUARTPS_IXR_RXOVR       0x00000001U     // RX FIFO trigger
+#define XUARTPS_IXR_RXFULL      0x00000004U
+#define XUARTPS_IXR_TXEMPTY     0x00000008U     // TX FIFO empty
+#define XUARTPS_IXR_OVER        0x00000020U     // RX FIFO overrun
+#define XUARTPS_IXR_TOUT        0x00000100U     // RX timeout
+#define XUARTPS_FIFO_DEPTH      64
+
+typedef struct {
+    u16 DeviceId;
+    UINTPTR BaseAddress;
+    u32 InputClockHz;
+} XUartPs_Config;
+
+typedef struct {
+    XUartPs_Config Config;
+    u32 BaudRate;
+    u32 IsReady;
+} XUartPs;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+XUartPs_Config* XUartPs_LookupConfig(u16 DeviceId);
+s32 XUartPs_CfgInitialize(XUartPs* InstancePtr, XUartPs_Config* Config, UINTPTR EffectiveAddr);
+s32 XUartPs_SetBaudRate(XUartPs* InstancePtr, u32 BaudRate);
+void XUartPs_SetInterruptMask(XUartPs* InstancePtr, u32 Mask);
+void XUartPs_SetFifoThreshold(XUartPs* InstancePtr, u8 TriggerLevel);
+void XUartPs_SetRecvTimeout(XUartPs* InstancePtr, u8 RecvTimeout);
+
+// Host only
+u32 host_uart_rx_ready(void);
+u32 host_uart_read_reg(u32 RegOffset);
+void host_uart_write_reg(u32 RegOffset, u32 Data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define XUartPs_IsReceiveData(BaseAddress)              host_uart_rx_ready()
+#define XUartPs_IsTransmitFull(BaseAddress)             FALSE
+#define XUartPs_ReadReg(BaseAddress, RegOffset)         host_uart_read_reg(RegOffset)
+#define XUartPs_WriteReg(BaseAddress, RegOffset, Data)  host_uart_write_reg(RegOffset, Data)
+
+#endif
\ No newline at end of file
@@ -0,0 +1,174 @@
+"""Sends the dataset to the board with the binary framed protocol of Proj/Vitis/uart.h (UART_BINARY_PROTOCOL).
+
+Replaces Realterm:
+    python3 send_frames.py --port /dev/ttyUSB1
+    python3 send_frames.py --port /dev/ttyUSB1 --cascade
+
+Or writes the frames to a file, for the host build (UART_INPUT_FILE):
+    python3 send_frames.py --output build/uart_input.bin [--inject-corrupt 2] [--repeat-last]
+
+Results come back as FRAME_TYPE_RESULTS frames, printed once all have arrived (--port),
+or decoded from a capture of the UART output (e.g of the host build):
+    python3 send_frames.py --decode capture.bin
+"""
+import argparse
+import os
+import struct
+import sys
+import time
+import zlib
+
+FRAME_SYNC = bytes([0xA5, 0x5A])
+FRAME_TYPE_ROWS = 0x01
+FRAME_TYPE_WEIGHTS = 0x02
+FRAME_TYPE_RESULTS = 0x03
+FRAME_HEADER_SIZE = 6
+FRAME_CRC_SIZE = 4
+NUMBER_OF_RESULTS = 64
+FRAME_MAX_PAYLOAD = 256
+FRAME_ACK = 0x06
+FRAME_NAK = 0x15
+
+BAUD_RATE = 921600          # MY_BAUD_RATE with UART_BINARY_PROTOCOL
+ACK_TIMEOUT_S = 0.5
+MAX_RETRIES = 8
+RESULTS_TIMEOUT_S = 5.0
+
+DATASET_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "Dataset")
+
+
+def read_csv_values(file_name):
+    values = []
+    with open(os.path.join(DATASET_DIR, file_name), "r") as read_file:
+        for read_line in read_file:
+            read_line = read_line.strip()
+            if read_line:
+                values += [int(value) for value in read_line.split(",")]
+    return values
+
+
+def build_frame(frame_type, seq, offset, payload):
+    # CRC-32 covers type to the end of the payload, same polynomial as crc32.c
+    header = struct.pack("<BBHH", frame_type, seq & 0xFF, len(payload), offset)
+    crc = zlib.crc32(header + payload) & 0xFFFFFFFF
+    return FRAME_SYNC + header + payload + struct.pack("<I", crc)
+
+
+def build_frames(cascade):
+    rows = bytes(read_csv_values("X.csv"))
+    weights_files = ["w_hid.csv", "w_out.csv"] + (["w_screen.csv", "screen_band.csv"] if cascade else [])
+    weights = bytes(sum((read_csv_values(file_name) for file_name in weights_files), []))
+
+    frames = []
+    for frame_type, values in ((FRAME_TYPE_WEIGHTS, weights), (FRAME_TYPE_ROWS, rows)):
+        for offset in range(0, len(values), FRAME_MAX_PAYLOAD):
+            frames.append(build_frame(frame_type, len(frames), offset, values[offset:offset+FRAME_MAX_PAYLOAD]))
+    return frames
+
+
+def corrupt(frame):
+    # Flip one payload bit, the CRC no longer matches
+    damaged = bytearray(frame)
+    damaged[len(FRAME_SYNC) + 6] ^= 0x01
+    return bytes(damaged)
+
+
+def parse_result_frames(stream):
+    # Text (xil_printf) between frames is skipped, so is any frame whose CRC does not match
+    results = {}
+    index = stream.find(FRAME_SYNC)
+    while index >= 0 and index + len(FRAME_SYNC) + FRAME_HEADER_SIZE <= len(stream):
+        header = stream[index+len(FRAME_SYNC):index+len(FRAME_SYNC)+FRAME_HEADER_SIZE]
+        frame_type, seq, length, offset = struct.unpack("<BBHH", header)
+        payload_start = index + len(FRAME_SYNC) + FRAME_HEADER_SIZE
+        payload = stream[payload_start:payload_start+length]
+        crc_bytes = stream[payload_start+length:payload_start+length+FRAME_CRC_SIZE]
+
+        if (frame_type == FRAME_TYPE_RESULTS and len(crc_bytes) == FRAME_CRC_SIZE
+                and struct.unpack("<I", crc_bytes)[0] == zlib.crc32(header + payload) & 0xFFFFFFFF):
+            for k, (value,) in enumerate(struct.iter_unpack("<H", payload)):
+                results[offset + k] = value
+            index = stream.find(FRAME_SYNC, payload_start + length + FRAME_CRC_SIZE)
+        else:
+            index = stream.find(FRAME_SYNC, index + 1)
+    return results
+
+
+def print_results(results):
+    print(" ".join(str(results.get(i, "?")) for i in range(NUMBER_OF_RESULTS)))
+
+
+def wait_for_reply(port):
+    # Anything other than ACK/NAK (e.g xil_printf output) is ignored
+    deadline = time.time() + ACK_TIMEOUT_S
+    while time.time() < deadline:
+        reply = port.read(1)
+        if reply and reply[0] in (FRAME_ACK, FRAME_NAK):
+            return reply[0]
+    return None
+
+
+def send_to_port(frames, port_name, baud_rate):
+    import serial   # pyserial
+
+    with serial.Serial(port_name, baud_rate, timeout=0.05) as port:
+        start = time.time()
+        for index, frame in enumerate(frames):
+            for attempt in range(MAX_RETRIES):
+                port.write(frame)
+                if wait_for_reply(port) == FRAME_ACK:
+                    break
+            else:
+                sys.exit("Frame %d not acknowledged after %d attempts" % (index, MAX_RETRIES))
+        elapsed = time.time() - start
+
+        num_bytes = sum(len(frame) for frame in frames)
+        print("Sent %d frames, %d bytes in %.3f s" % (len(frames), num_bytes, elapsed))
+
+        # Results follow once the board has computed them
+        stream = b""
+        deadline = time.time() + RESULTS_TIMEOUT_S
+        while time.time() < deadline and len(parse_result_frames(stream)) < NUMBER_OF_RESULTS:
+            stream += port.read(256)
+    print_results(parse_result_frames(stream))
+
+
+def write_to_file(frames, file_name, inject_corrupt, repeat_last):
+    with open(file_name, "wb") as write_file:
+        for index, frame in enumerate(frames):
+            # No back channel in a file, the corrupt copy is simply followed by the good one
+            if inject_corrupt is not None and index == inject_corrupt:
+                write_file.write(corrupt(frame))
+            write_file.write(frame)
+        # As if the ACK of the last frame got lost, the board has to acknowledge it again without storing it twice
+        if repeat_last:
+            write_file.write(frames[-1])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", help="serial port of the board")
+    parser.add_argument("--baud", type=int, default=BAUD_RATE)
+    parser.add_argument("--output", help="write the frames to a file instead")
+    parser.add_argument("--cascade", action="store_true", help="also send w_screen.csv, screen_band.csv (CASCADE_MODE)")
+    parser.add_argument("--decode", metavar="CAPTURE", help="print the results found in a capture of the UART output")
+    parser.add_argument("--inject-corrupt", type=int, metavar="FRAME", help="with --output, precede frame FRAME with a corrupt copy")
+    parser.add_argument("--repeat-last", action="store_true", help="with --output, send the last frame twice")
+    args = parser.parse_args()
+
+    if args.decode:
+        with open(args.decode, "rb") as read_file:
+            print_results(parse_result_frames(read_file.read()))
+        return
+
+    frames = build_frames(args.cascade)
+    if args.output:
+        write_to_file(frames, args.output, args.inject_corrupt, args.repeat_last)
+    elif args.port:
+        send_to_port(frames, args.port, args.baud)
+    else:
+        parser.error("one of --port, --output, --decode is required")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,124 @@
+// Counters of the result cache (result_cache.h) on row patterns whose set mapping is known
+// Built by 'make test-result-cache' in Proj/Vitis/host, exits non-zero on the first failed check
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// Static helpers (hash_row) pick the rows that collide in one set
+#include "result_cache.c"
+
+void xil_printf(const char* ctrl1, ...) {
+    va_list args;
+    va_start(args, ctrl1);
+    vprintf(ctrl1, args);
+    va_end(args);
+}
+
+#define MODEL_ID    0x1234u
+#define SET_ROWS    (RESULT_CACHE_NUM_WAYS + 1)    // One more than the set holds
+
+static int inputs[2*NUMBER_OF_INPUT_WORDS];
+static int results[2*NUMBER_OF_OUTPUT_WORDS];
+static u8 cached_results[2*A_NUM_ROWS];
+static int row_source[2*A_NUM_ROWS];
+static int num_failures = 0;
+
+static void check(const char* what, u32 value, u32 expected) {
+    printf("%-40s %5u (expected %u)%s\n", what, value, expected, (value == expected) ? "" : "  FAIL");
+    if (value != expected) num_failures++;
+}
+
+static void make_row(int* row, int seed) {
+    for (int j = 0; j < A_NUM_COLS; j++) {
+        row[j] = (seed >> (4*j)) & 0xFF;
+    }
+}
+
+static u32 row_set(int* row) {
+    return hash_row(MODEL_ID, row) & (RESULT_CACHE_NUM_SETS-1);
+}
+
+static void make_batch(int* batch, int set_rows[SET_ROWS][A_NUM_COLS], int* other_row) {
+    // SET_ROWS rows of one set first, then a single row of another set repeated
+    for (int i = 0; i < A_NUM_ROWS; i++) {
+        int* row = (i < SET_ROWS) ? set_rows[i] : other_row;
+        memcpy(&batch[A_OFFSET + i*A_NUM_COLS], row, A_NUM_COLS*sizeof(int));
+    }
+}
+
+static void compute_misses(int num_misses) {
+    // Stand-in for SOFT/HARD, the result only depends on the datapoint
+    for (int k = 0; k < num_misses; k++) {
+        results[k] = hash_row(0, workload_row(inputs, k)) & 0xFF;
+    }
+}
+
+static void run_workload(result_cache* cache, int num_batches, int* num_misses) {
+    *num_misses = result_cache_partition(cache, MODEL_ID, inputs, num_batches, cached_results, row_source);
+    compute_misses(*num_misses);
+    result_cache_fill(cache, MODEL_ID, inputs, *num_misses, results);
+}
+
+int main() {
+    static int set_rows[SET_ROWS][A_NUM_COLS];
+    static int other_row[A_NUM_COLS];
+    static int batch[NUMBER_OF_INPUT_WORDS];
+    result_cache cache;
+    int num_misses;
+
+    // SET_ROWS distinct rows of the set of the first one, and a row of any other set
+    int num_found = 0;
+    int seed = 1;
+    make_row(set_rows[0], seed);
+    u32 set = row_set(set_rows[0]);
+    for (num_found = 1; num_found < SET_ROWS; seed++) {
+        make_row(set_rows[num_found], seed + 1);
+        if (row_set(set_rows[num_found]) == set) num_found++;
+    }
+    do {
+        make_row(other_row, ++seed);
+    } while (row_set(other_row) == set);
+    make_batch(batch, set_rows, other_row);
+
+    // One batch: the last row of the set evicts the first (still PENDING), the repeated row finds its PENDING entry (dedups)
+    result_cache_init(&cache);
+    memcpy(inputs, batch, sizeof(batch));
+    run_workload(&cache, 1, &num_misses);
+    check("first batch: misses", cache.misses, SET_ROWS + 1);
+    check("first batch: hits", cache.hits, 0);
+    check("first batch: dedups", cache.dedups, A_NUM_ROWS - SET_ROWS - 1);
+    check("first batch: evictions", cache.evictions, 1);
+    check("first batch: HW batches", result_cache_num_batches(num_misses), 1);
+
+    // Same batch again: LRU cycles through the set (every row of it misses), the repeated row hits
+    memcpy(inputs, batch, sizeof(batch));
+    run_workload(&cache, 1, &num_misses);
+    check("second batch: misses", cache.misses, 2*SET_ROWS + 1);
+    check("second batch: hits", cache.hits, A_NUM_ROWS - SET_ROWS);
+    check("second batch: dedups", cache.dedups, A_NUM_ROWS - SET_ROWS - 1);
+    check("second batch: evictions", cache.evictions, 1 + SET_ROWS);
+
+    // Two batches of a workload: the set cycles as above, the repeated row of the second batch is a dedup as well, all misses fit one HW batch
+    result_cache_init(&cache);
+    memcpy(inputs, batch, sizeof(batch));
+    memcpy(inputs + NUMBER_OF_INPUT_WORDS, batch, sizeof(batch));
+    run_workload(&cache, 2, &num_misses);
+    check("two batches: misses", cache.misses, 2*SET_ROWS + 1);
+    check("two batches: hits", cache.hits, 0);
+    check("two batches: dedups", cache.dedups, 2*(A_NUM_ROWS - SET_ROWS) - 1);
+    check("two batches: evictions", cache.evictions, 1 + SET_ROWS);
+    check("two batches: HW batches", result_cache_num_batches(num_misses), 1);
+
+    // Results go back into datapoint order, the same for both batches
+    compute_misses(num_misses);
+    result_cache_expand_hard(cached_results, row_source, 2*A_NUM_ROWS, results);
+    int num_wrong = 0;
+    for (int i = 0; i < A_NUM_ROWS; i++) {
+        if (results[A_NUM_ROWS + i] != results[i]) num_wrong++;
+    }
+    check("two batches: rows differing between them", num_wrong, 0);
+
+    result_cache_print_stats(&cache);
+    printf("%s\n", num_failures ? "Result cache test failed" : "Result cache test passed");
+    return num_failures ? 1 : 0;
+}
\ No newline at end of file
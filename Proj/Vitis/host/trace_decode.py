@@ -0,0 +1,127 @@
+"""Decodes the binary trace ring of Proj/Vitis/trace.h (TRACE) out of a capture of the UART output.
+
+The board dumps the ring once it receives 't' after the run, in between its text output:
+    python3 trace_decode.py capture.bin                      one line per record
+    python3 trace_decode.py capture.bin --chrome trace.json  Chrome trace, open in chrome://tracing or ui.perfetto.dev
+
+Records of interrupt handlers go on their own track, _BEGIN/_END pairs become spans (async ones per batch).
+"""
+import argparse
+import json
+import struct
+import sys
+
+TRACE_DUMP_MAGIC = b"TRCE"
+HEADER_FORMAT = "<4sIII"        # magic, records in the dump, records dropped, COUNTS_PER_SECOND
+RECORD_FORMAT = "<IHHII"        # timestamp, event, arg0, arg1, arg2
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+RECORD_SIZE = struct.calcsize(RECORD_FORMAT)
+
+# Same order as trace_event of trace.h: name, names of the args it uses, raised in an ISR
+EVENTS = [
+    ("HARD_BEGIN", ["batches"], False),
+    ("HARD_END", [], False),
+    ("BATCH_BEGIN", ["batch"], False),
+    ("BATCH_END", ["batch"], False),
+    ("AXIS_TX_CHUNK", ["batch", "words"], False),
+    ("AXIS_RX_IRQ", ["batch"], True),
+    ("AXIS_RX_COPY", ["batch", "bytes", "irq_delay_cycles"], False),
+    ("AXIS_RX_POLL", ["batch", "polls"], False),
+    ("AXIS_RX_TIMEOUT", ["batch"], False),
+    ("DMA_MM2S_IRQ", ["next_batch"], True),
+    ("DMA_S2MM_IRQ", ["batch"], True),
+    ("DMA_ERROR", ["channel", "irq_status"], True),
+    ("BACKEND_SWITCH", ["command"], False),
+    ("VERIFY_WORD", ["word", "result", "expected"], False),
+    ("VERIFY_MISMATCH", ["word", "result", "expected"], False),
+    ("MODEL_UPLOAD", ["model", "model_id"], False),
+]
+
+
+def find_dump(capture):
+    # Text before and after the dump is the board's xil_printf output
+    start = capture.find(TRACE_DUMP_MAGIC)
+    if start < 0:
+        sys.exit("no trace dump in the capture")
+
+    _, num_records, num_dropped, counts_per_second = struct.unpack_from(HEADER_FORMAT, capture, start)
+    end = start + HEADER_SIZE + num_records*RECORD_SIZE
+    if end > len(capture):
+        sys.exit("trace dump cut short, %d of %d records" % ((len(capture) - start - HEADER_SIZE) // RECORD_SIZE, num_records))
+
+    records = [struct.unpack_from(RECORD_FORMAT, capture, start + HEADER_SIZE + k*RECORD_SIZE) for k in range(num_records)]
+    return records, num_dropped, counts_per_second
+
+
+def decode(records, counts_per_second):
+    # Timestamps are the low word of the global timer, oldest first
+    # An ISR record may land between another record's slot and its timer read, so a step may also go back a little
+    # Each step is taken as the signed 32-bit difference to the previous record, only a step of more than 2^31 is a wrap
+    events = []
+    time = None
+    for timestamp, event, arg0, arg1, arg2 in records:
+        if time is None:
+            time = timestamp
+        else:
+            step = (timestamp - time) & 0xFFFFFFFF
+            time += step - (1 << 32) if step >= (1 << 31) else step
+        time_us = time * 1e6 / counts_per_second
+
+        name, arg_names, in_isr = EVENTS[event] if event < len(EVENTS) else ("EVENT_%d" % event, ["arg0", "arg1", "arg2"], False)
+        args = dict(zip(arg_names, [arg0, arg1, arg2]))
+        if name == "BACKEND_SWITCH":
+            args["command"] = chr(arg0)
+        events.append((time_us, name, args, in_isr))
+    return events
+
+
+def print_text(events, num_dropped):
+    if num_dropped:
+        print("%d older records dropped" % num_dropped)
+    start_us = events[0][0] if events else 0
+    for time_us, name, args, in_isr in events:
+        print("%12.3f us  %-16s %s%s" % (time_us - start_us, name, " ".join("%s=%s" % item for item in args.items()),
+                                         "  (ISR)" if in_isr else ""))
+
+
+def write_chrome(events, file_name):
+    trace_events = [
+        {"name": "thread_name", "ph": "M", "pid": 0, "tid": 0, "args": {"name": "main"}},
+        {"name": "thread_name", "ph": "M", "pid": 0, "tid": 1, "args": {"name": "ISR"}},
+    ]
+    for time_us, name, args, in_isr in events:
+        # Batches overlap with HARD_DOUBLE_BUFFER, so their spans are async ones keyed by batch, they need not nest
+        if name.endswith(("_BEGIN", "_END")) and "batch" in args:
+            phase = "b" if name.endswith("_BEGIN") else "e"
+            trace_events.append({"name": name.rsplit("_", 1)[0], "cat": "batch", "ph": phase, "id": args["batch"], "ts": time_us,
+                                 "pid": 0, "tid": 0, "args": args})
+        elif name.endswith("_BEGIN"):
+            trace_events.append({"name": name[:-len("_BEGIN")], "ph": "B", "ts": time_us, "pid": 0, "tid": 0, "args": args})
+        elif name.endswith("_END"):
+            trace_events.append({"name": name[:-len("_END")], "ph": "E", "ts": time_us, "pid": 0, "tid": 0, "args": args})
+        else:
+            trace_events.append({"name": name, "ph": "i", "s": "t", "ts": time_us, "pid": 0, "tid": 1 if in_isr else 0, "args": args})
+
+    with open(file_name, "w") as write_file:
+        json.dump({"traceEvents": trace_events, "displayTimeUnit": "ns"}, write_file)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="capture of the UART output holding the dump")
+    parser.add_argument("--chrome", metavar="JSON", help="write a Chrome trace instead of printing the records")
+    args = parser.parse_args()
+
+    with open(args.capture, "rb") as read_file:
+        records, num_dropped, counts_per_second = find_dump(read_file.read())
+    events = decode(records, counts_per_second)
+
+    if args.chrome:
+        write_chrome(events, args.chrome)
+        print("%d records written to %s" % (len(events), args.chrome))
+    else:
+        print_text(events, num_dropped)
+
+
+if __name__ == "__main__":
+    main()
\ No newline at end of file
@@ -8,8 +8,14 @@
 #define INTC_DEVICE_ID          XPAR_SCUGIC_SINGLE_DEVICE_ID   // SCUGIC
 #define FIFO_INTR_ID            XPAR_FABRIC_LLFIFO_0_VEC_ID    // AXI_FIFO_MM_S_0 fabric interrupt
 #define TMRCTR_INTERRUPT_ID     XPAR_FABRIC_TMRCTR_0_VEC_ID    // AXI-Timer Interrupt
+#define DMA_MM2S_INTR_ID        XPAR_FABRIC_AXIDMA_0_MM2S_INTROUT_VEC_ID   // AXI_DMA_0 MM2S completion
+#define DMA_S2MM_INTR_ID        XPAR_FABRIC_AXIDMA_0_S2MM_INTROUT_VEC_ID   // AXI_DMA_0 S2MM completion
+#define UART_INTR_ID            XPAR_XUARTPS_0_INTR            // PS UART0
 
 #define FIFO_INTERRUPT_PRIORITY      160
+#define DMA_INTERRUPT_PRIORITY       160
+#define UART_INTERRUPT_PRIORITY      152    // Above the others, the 64 byte RX FIFO overruns otherwise
 #define AXI_TIMER_INTERRUPT_PRIORITY 240
 #define RISING_EDGE_SENSIIVE    3
+#define HIGH_LEVEL_SENSITIVE    1      // PS peripherals (SPI) are level sensitive
 #define NUM_RX_PACKETS_EXPECTED 1
\ No newline at end of file
@@ -4,86 +4,234 @@ int main()
 {
     u32 sw_mult_time = 0;
     u32 hw_mult_time = 0;
+    u32 result_tx_time = 0;
+    u32 kickoff_time = 0;
+
+    #ifdef SOFT_PARALLEL_WORKER_CORE
+        // Cores 1..3 only compute SOFT slices for core 0 (soft_parallel.h)
+        soft_parallel_worker(SOFT_PARALLEL_WORKER_CORE);
+    #endif
 
     if (initialization() != XST_SUCCESS) {
         xil_printf("Initialization failure\n");
         return XST_FAILURE;
     }
 
-    #ifndef HARD_HLS
+    #if !defined(HARD_HLS) && defined(AXI_DMA_INTERRUPT_MODE)
+        xil_printf("HARD_HDL chosen. AXI-DMA(Interrupt).\n");
+    #elif !defined(HARD_HLS)
         xil_printf("HARD_HDL chosen. AXI-DMA(Polling).\n");
     #else
         xil_printf("HARD_HLS chosen. AXI-Stream(Interrupt).\n");
     #endif
 
     // Accept files from UART, store data into memory
-    xil_printf("Ready to accept files from Realterm\n");
-    receive_from_realterm(UART_BASEADDR, recv_a_matrix, recv_b_matrix, recv_c_matrix, HARD_input_memory);
-    xil_printf("Files received from Realterm\n");
-
-    xil_printf("Kickoff SOFT and HARD calculations\n");
-    // 1. Load value in TLR0 to TCR0 (by writing to LOAD0)
-    // 2. Clear LOAD0, set ENT0 (to let counter run)
-    XTmrCtr_Start(TimerCtrInstancePtr, TIMER_CNTR_0);
+    #ifdef UART_BINARY_PROTOCOL
+        xil_printf("Ready to accept frames\n");
+        PROFILE_BEGIN(PROFILE_UART_INGEST);
+        int num_rejected_frames = receive_frames(UART_BASEADDR, HARD_input_memory);
+        PROFILE_END(PROFILE_UART_INGEST);
+        xil_printf("Frames received, %d rejected\n", num_rejected_frames);
+    #elif defined(UART_RX_INTERRUPT_MODE)
+        xil_printf("Ready to accept files from Realterm, weights first\n");
+        if (stream_processing() != XST_SUCCESS) return XST_FAILURE;
+        uart_tx_flush(UART_BASEADDR);
+        xil_printf("Files received from Realterm, results sent back as they were computed\n");
+        stream_print_latency();
+    #else
+        xil_printf("Ready to accept files from Realterm\n");
+        PROFILE_BEGIN(PROFILE_UART_INGEST);
+        receive_from_realterm(UART_BASEADDR, HARD_input_memory);
+        PROFILE_END(PROFILE_UART_INGEST);
+        xil_printf("Files received from Realterm\n");
+    #endif
 
-    SOFT_processing(recv_a_matrix, recv_b_matrix, recv_c_matrix, SOFT_hidden_layer_neurons, SOFT_output_layer_neurons);
+    #if NUMBER_OF_TEST_VECTORS > 1
+        // Files only carry one batch, the rest of the workload repeats it
+        PROFILE_BEGIN(PROFILE_PACK);
+        for (int word_cnt = NUMBER_OF_INPUT_WORDS; word_cnt < NUMBER_OF_TEST_VECTORS*NUMBER_OF_INPUT_WORDS; word_cnt++) {
+            HARD_input_memory[word_cnt] = HARD_input_memory[word_cnt % NUMBER_OF_INPUT_WORDS];
+        }
+        PROFILE_END(PROFILE_PACK);
+    #endif
 
-    // Read from TCR0
-	sw_mult_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0);
+    #ifdef SOFT_SIMD_BENCHMARK
+        if (soft_simd_benchmark(TimerCtrInstancePtr, recv_a_matrix, recv_b_matrix, recv_c_matrix) != XST_SUCCESS) return XST_FAILURE;
+    #endif
+    #ifdef SOFT_PARALLEL_BENCHMARK
+        if (soft_parallel_benchmark(recv_a_matrix, recv_b_matrix, recv_c_matrix) != XST_SUCCESS) return XST_FAILURE;
+    #endif
+    #ifdef BENCHMARK_MODE
+        if (bench_run_all() != XST_SUCCESS) return XST_FAILURE;
+    #endif
 
+    #ifdef RESULT_CACHE
+        // Reference of verify(), computed in full before the cache compacts the A matrix, a wrong cached result then shows up as a mismatch
+        SOFT_MLP(recv_a_matrix, recv_b_matrix, recv_c_matrix, SOFT_hidden_layer_neurons, SOFT_output_layer_neurons, 0, A_NUM_ROWS);
+    #endif
 
-    #ifndef HARD_HLS
-        for (int test_case_cnt = 0; test_case_cnt < NUMBER_OF_TEST_VECTORS; test_case_cnt++) {
-            int Status;
+    #ifndef UART_RX_INTERRUPT_MODE
+        xil_printf("Kickoff SOFT and HARD calculations\n");
+        // 1. Load value in TLR0 to TCR0 (by writing to LOAD0)
+        // 2. Clear LOAD0, set ENT0 (to let counter run)
+        // Left running when cascaded (PROFILE, BENCHMARK_MODE), hence the kickoff time
+        timer_restart(TimerCtrInstancePtr);
+        kickoff_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0);
+    #endif
 
-            /*********** TX, Main Memory --> Coprocessor ************/
-            Status = mm2s_transmit(&AxiDma, test_case_cnt);
-            if (Status != XST_SUCCESS) {
-                xil_printf("mm2s TX error\n");
-                return XST_FAILURE;
-            } 
-            /*********** RX, Coprocessor --> Main Memory ************/
-            Status = s2mm_transmit(&AxiDma, test_case_cnt);
-            if (Status != XST_SUCCESS) {
-                xil_printf("s2mm TX error\n");
-                return XST_FAILURE;
-            } 
+    #ifdef RESULT_CACHE
+        // Only datapoints which miss in the cache are computed, by both SOFT and HARD
+        // Every batch of the workload is looked up, the misses of all of them are compacted in place into the first batches
+        PROFILE_BEGIN(PROFILE_PACK);
+        model_id = result_cache_model_id(recv_b_matrix, recv_c_matrix);
+        num_misses = result_cache_partition(&ResultCache, model_id, HARD_input_memory, NUMBER_OF_TEST_VECTORS,
+                                            cached_results, cached_row_source);
+        num_hard_batches = result_cache_num_batches(num_misses);
+        PROFILE_END(PROFILE_PACK);
+
+        PROFILE_BEGIN(PROFILE_SOFT);
+        for (int batch = 0; batch < num_hard_batches; batch++) {
+            int* inputs = &HARD_input_memory[batch*NUMBER_OF_INPUT_WORDS];
+            int num_rows = (num_misses - batch*A_NUM_ROWS < A_NUM_ROWS) ? num_misses - batch*A_NUM_ROWS : A_NUM_ROWS;
+            SOFT_MLP(inputs + A_OFFSET, inputs + B_OFFSET, inputs + C_OFFSET, SOFT_hidden_layer_neurons,
+                     &cached_soft_misses[batch*A_NUM_ROWS], 0, num_rows);
         }
+        PROFILE_END(PROFILE_SOFT);
+    #elif defined(UART_RX_INTERRUPT_MODE)
+        // Already computed while receiving
+    #elif defined(CASCADE_MODE)
+        PROFILE_BEGIN(PROFILE_SOFT);
+        SOFT_cascade_processing(recv_a_matrix, recv_b_matrix, recv_c_matrix, recv_s_matrix, recv_band,
+                                SOFT_output_layer_neurons, SOFT_decided_stage, 0, A_NUM_ROWS);
+        PROFILE_END(PROFILE_SOFT);
     #else
-        // Communicate to Coprocessor IP via AXI-Stream
-        for (; test_case_cnt < NUMBER_OF_TEST_VECTORS; test_case_cnt++) {
-            /********************* TX *********************/
-            if (AXIS_transmit(FifoInstancePtr, HARD_input_memory) != XST_SUCCESS) {
-                xil_printf("TX error\n");
-                return XST_FAILURE;
-            }
+        PROFILE_BEGIN(PROFILE_SOFT);
+        SOFT_MLP(recv_a_matrix, recv_b_matrix, recv_c_matrix, SOFT_hidden_layer_neurons, SOFT_output_layer_neurons, 0, A_NUM_ROWS);
+        PROFILE_END(PROFILE_SOFT);
+    #endif
 
-            // Interrupt mode: Do other work while waiting for TX completion
-            #ifndef AXI_STREAM_POLLING_MODE
-                while (!TX_done) {
-                    asm("nop");
-                    //xil_printf("Busy TX\n");
-                }
-            #endif
-
-            /********************* RX *********************/
-            // Polling mode: Polling read of RDRO register
-            // Interrupt mode: Only read RDRO register when RC flag is raised
-            if (AXIS_receive(FifoInstancePtr) != XST_SUCCESS) {
-                xil_printf("RX error\n");
-                return XST_FAILURE;
+    #ifndef UART_RX_INTERRUPT_MODE
+        // Read from TCR0
+        sw_mult_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0) - kickoff_time;
+
+        #ifdef HETERO_SPLIT
+            // HARD and SOFT share every workload, the SOFT run above only serves as the reference for verify()
+            for (int round = 0; round < HETERO_ROUNDS; round++) {
+                if (hetero_processing() != XST_SUCCESS) return XST_FAILURE;
             }
-        }
+        #else
+            if (HARD_processing(num_hard_batches) != XST_SUCCESS) return XST_FAILURE;
+        #endif
     #endif
 
 
-	hw_mult_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0) - sw_mult_time;
-    // TODO: For more accuracy, we can reset Timer0 before counting for HW mult
-    xil_printf("SW mult is %d\n", sw_mult_time);
-    xil_printf("HW mult is %d", hw_mult_time);
+    #ifdef RESULT_CACHE
+        // Remember the computed results, then restore datapoint order for verification
+        // SOFT only keeps the first batch, all batches are copies of it
+        result_cache_fill(&ResultCache, model_id, HARD_input_memory, num_misses, HARD_result_memory);
+        result_cache_expand_soft(cached_results, cached_row_source, A_NUM_ROWS, cached_soft_misses, cached_soft_output);
+        result_cache_expand_hard(cached_results, cached_row_source, NUMBER_OF_TEST_VECTORS*A_NUM_ROWS, HARD_result_memory);
+    #endif
+
+    #ifdef UART_RX_INTERRUPT_MODE
+        // Summed over the micro-batches
+        sw_mult_time = STREAM_soft_time;
+        hw_mult_time = STREAM_hard_time;
+    #else
+        hw_mult_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0) - kickoff_time - sw_mult_time;
+
+        // Send the results back, only the CPU time is counted, the bytes leave in the background (UART_TX_INTERRUPT_MODE)
+        u32 tx_start_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0);
+        PROFILE_BEGIN(PROFILE_RESULT_TX);
+        send_results(UART_BASEADDR, HARD_result_memory, 0, NUMBER_OF_TEST_VECTORS*NUMBER_OF_OUTPUT_WORDS);
+        PROFILE_END(PROFILE_RESULT_TX);
+        result_tx_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0) - tx_start_time;
+    #endif
+    uart_tx_flush(UART_BASEADDR);
+    #ifdef PROFILE
+        // Every phase is timed on its own instead, printed after verify()
+        (void)sw_mult_time;
+        (void)hw_mult_time;
+        (void)result_tx_time;
+    #else
+        // HW mult is the difference of two reads of the free running Timer0, no reset needed in between
+        xil_printf("SW mult is %d\n", sw_mult_time);
+        xil_printf("HW mult is %d", hw_mult_time);
+        #ifndef UART_RX_INTERRUPT_MODE
+            xil_printf("\nResult TX is %d", result_tx_time);
+        #endif
+    #endif
+
+    #ifdef BACKEND_FIFO_USED
+        xil_printf("\nAXIS TX: %d words in %d chunks of up to %d words, %d cycles", AXIS_tx_words, AXIS_tx_chunks, AXIS_TX_CHUNK_WORDS, AXIS_tx_time);
+    #endif
+
+    #ifdef BACKEND_FIFO_IRQ_USED
+        xil_printf("\nAXIS RX: copied out up to %d cycles after the interrupt, %d descriptors dropped", AXIS_rx_max_delay, axis_rx_ring_overflows());
+    #endif
+
+    #ifdef UART_RX_INTERRUPT_MODE
+        xil_printf("\nMicro-batches run: %d, up to %d datapoints each", STREAM_num_dispatches, STREAM_MICRO_BATCH_ROWS);
+    #endif
+
+    #ifdef SOFT_PARALLEL
+        soft_parallel_print_timing();
+    #endif
+
+    #ifdef HETERO_SPLIT
+        hetero_print_stats(&HeteroScheduler);
+    #endif
+
+    #ifdef CASCADE_MODE
+        xil_printf("\nCascade: %d of %d datapoints went through the full MLP", SOFT_num_full_rows, A_NUM_ROWS);
+    #endif
+
+    #ifdef RESULT_CACHE
+        xil_printf("\nHW batches run: %d of %d\n", num_hard_batches, NUMBER_OF_TEST_VECTORS);
+        result_cache_print_stats(&ResultCache);
+    #endif
+
+    #ifdef MODEL_REGISTRY
+        xil_printf("\n");
+        model_registry_print_stats(&ModelRegistry);
+    #endif
 
     // Verify results
-    return (verify());
+    PROFILE_BEGIN(PROFILE_VERIFY);
+    int status = verify();
+    PROFILE_END(PROFILE_VERIFY);
+
+    #ifdef RESULT_CACHE
+        // verify() checked HARD through the cache, SOFT through the cache must match the full SOFT run as well
+        int num_soft_mismatches = 0;
+        for (int i = 0; i < A_NUM_ROWS; i++) {
+            if (cached_soft_output[i] != SOFT_output_layer_neurons[i]) num_soft_mismatches++;
+        }
+        if (num_soft_mismatches != 0) {
+            xil_printf("Result cache: %d SOFT results differ from the full SOFT run\n", num_soft_mismatches);
+            status = XST_FAILURE;
+        }
+    #endif
+
+    #ifdef PROFILE
+        profile_print();
+    #endif
+
+    #ifdef RUNTIME_BACKENDS
+        if (backend_session() != XST_SUCCESS) return XST_FAILURE;
+    #endif
+
+    #if defined(TRACE) && defined(UART_RX_INTERRUPT_MODE)
+        // RX belongs to the ISR, no command can be read, the dump follows right away
+        trace_dump(UART_BASEADDR);
+    #elif defined(TRACE)
+        // Only on request, so the terminal can start capturing the binary dump first
+        xil_printf("Trace: %d records, send '%c' to dump\n", trace_num_records(), TRACE_DUMP_COMMAND);
+        while (receive_command(UART_BASEADDR) != TRACE_DUMP_COMMAND) {}
+        trace_dump(UART_BASEADDR);
+    #endif
+
+    return status;
 }
 
 
@@ -99,31 +247,20 @@ static void axi_stream_interrupt_handler (XLlFifo* FifoInstancePtr) {
             TX_done = 1;
             XLlFifo_IntClear(FifoInstancePtr, XLLF_INT_TC_MASK);
         }
+        else if (Pending & XLLF_INT_TFPE_MASK) {
+            // TX FIFO drained below its programmable empty threshold, AXIS_transmit may have been waiting for room
+            TX_done = 1;
+            XLlFifo_IntClear(FifoInstancePtr, XLLF_INT_TFPE_MASK);
+        }
         else if (Pending & XLLF_INT_RC_MASK) {
-            xil_printf("ISR's RC triggered\n");
-
             /* ISR's RC flag is raised
                 - Indicates that at least one successful receive of packet(s) has completed
-                - Received packet's data and length are available
                 - Note this interrupt can represent MORE than one packet received
-                    We must check FIFO's RX occupancy to determine if we have additional received packets for processing
+                Only hand a descriptor to the bottom half (AXIS_rx_bottom_half), which reads the FIFO's RX outside of the ISR
+                Keeps the ISR short, so the next interrupt is not held up behind a copy of the whole packet
             */
-
-            // Check the number of words (32-bit sized in our case) avail from FIFO's RX
-            // It tells is the number of locations in use for data storage in the FIFO's RX, after the most recent transaction
-            // Note this value is only updated after a packet is SUCCESSFULLY received
-            // Reads from RDRO register, https://docs.xilinx.com/r/en-US/pg080-axi-fifo-mm-s/Interrupt-Status-Register-ISR
-            while (XLlFifo_iRxOccupancy(FifoInstancePtr)) {
-                // We are expecting only one packet from testbench per testcase
-                u32 received_length = XLlFifo_iRxGetLen(FifoInstancePtr);
-
-                for (int word_cnt=0; word_cnt < received_length/WORD_SIZE_IN_BYTES; word_cnt++) {
-                        u32 RxWord = XLlFifo_RxGetWord(FifoInstancePtr);
-                        HARD_result_memory[word_cnt+test_case_cnt*NUMBER_OF_OUTPUT_WORDS] = RxWord;
-                }
-            }
-
-            packets_received++;
+            axis_rx_ring_push(test_case_cnt, XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0));
+            TRACE_INFO(TRACE_AXIS_RX_IRQ, test_case_cnt, 0, 0);
             XLlFifo_IntClear(FifoInstancePtr, XLLF_INT_RC_MASK);
         }
         else {
@@ -165,21 +302,53 @@ int init_interrupts(XScuGic* IntC, XLlFifo* FifoInstancePtr, XTmrCtr* TimerCtrIn
    if (Status != XST_SUCCESS) return XST_FAILURE;
 
    // Sets priority/trigger types for our specified IRQ sources
-   #ifndef AXI_STREAM_POLLING_MODE
+   #ifdef BACKEND_FIFO_IRQ_USED
         XScuGic_SetPriorityTriggerType(IntC, (u16)FIFO_INTR_ID,
                                     FIFO_INTERRUPT_PRIORITY, RISING_EDGE_SENSIIVE);
    #endif
+   #if !defined(HARD_HLS) && defined(AXI_DMA_INTERRUPT_MODE)
+        XScuGic_SetPriorityTriggerType(IntC, (u16)DMA_MM2S_INTR_ID,
+                                    DMA_INTERRUPT_PRIORITY, RISING_EDGE_SENSIIVE);
+        XScuGic_SetPriorityTriggerType(IntC, (u16)DMA_S2MM_INTR_ID,
+                                    DMA_INTERRUPT_PRIORITY, RISING_EDGE_SENSIIVE);
+   #endif
+   #ifdef UART_INTERRUPTS_USED
+        XScuGic_SetPriorityTriggerType(IntC, (u16)UART_INTR_ID,
+                                    UART_INTERRUPT_PRIORITY, HIGH_LEVEL_SENSITIVE);
+   #endif
    XScuGic_SetPriorityTriggerType(IntC, (u16) TMRCTR_INTERRUPT_ID,
                             AXI_TIMER_INTERRUPT_PRIORITY, RISING_EDGE_SENSIIVE);
 
     // Connect our interrupt handlers
-    #ifndef AXI_STREAM_POLLING_MODE
+    #ifdef BACKEND_FIFO_IRQ_USED
         Status = XScuGic_Connect(IntC, (u16)FIFO_INTR_ID,
                     (Xil_InterruptHandler)axi_stream_interrupt_handler, FifoInstancePtr);
         if (Status != XST_SUCCESS) {
             xil_printf("Fail to connect AXIS-FIFO interrupt handler\n");
             return Status;
         }
+    #endif
+    #if !defined(HARD_HLS) && defined(AXI_DMA_INTERRUPT_MODE)
+        Status = XScuGic_Connect(IntC, (u16)DMA_MM2S_INTR_ID,
+                    (Xil_InterruptHandler)dma_mm2s_interrupt_handler, &AxiDma);
+        if (Status != XST_SUCCESS) {
+            xil_printf("Fail to connect AXI-DMA MM2S interrupt handler\n");
+            return Status;
+        }
+        Status = XScuGic_Connect(IntC, (u16)DMA_S2MM_INTR_ID,
+                    (Xil_InterruptHandler)dma_s2mm_interrupt_handler, &AxiDma);
+        if (Status != XST_SUCCESS) {
+            xil_printf("Fail to connect AXI-DMA S2MM interrupt handler\n");
+            return Status;
+        }
+    #endif
+    #ifdef UART_INTERRUPTS_USED
+        Status = XScuGic_Connect(IntC, (u16)UART_INTR_ID,
+                    (Xil_InterruptHandler)uart_interrupt_handler, &Uart_Ps);
+        if (Status != XST_SUCCESS) {
+            xil_printf("Fail to connect UART interrupt handler\n");
+            return Status;
+        }
     #endif
 	Status = XScuGic_Connect(IntC, (u16)TMRCTR_INTERRUPT_ID,
 				(Xil_InterruptHandler)timer_interrupt_handler, TimerCtrInstancePtr);
@@ -189,9 +358,16 @@ int init_interrupts(XScuGic* IntC, XLlFifo* FifoInstancePtr, XTmrCtr* TimerCtrIn
     }
 
     // Enable interrupts
-    #ifndef AXI_STREAM_POLLING_MODE
+    #ifdef BACKEND_FIFO_IRQ_USED
         XScuGic_Enable(IntC, (u16)FIFO_INTR_ID);
     #endif
+    #if !defined(HARD_HLS) && defined(AXI_DMA_INTERRUPT_MODE)
+        XScuGic_Enable(IntC, (u16)DMA_MM2S_INTR_ID);
+        XScuGic_Enable(IntC, (u16)DMA_S2MM_INTR_ID);
+    #endif
+    #ifdef UART_INTERRUPTS_USED
+        XScuGic_Enable(IntC, (u16)UART_INTR_ID);
+    #endif
     //TODO: TMRCTR Interrupt logic not implemented yet
     //XScuGic_Enable(IntC, (u16)TMRCTR_INTERRUPT_ID);
 
@@ -210,38 +386,83 @@ int init_interrupts(XScuGic* IntC, XLlFifo* FifoInstancePtr, XTmrCtr* TimerCtrIn
 }
 
 /*********************************** AXI-Stream TX,RX *********************************************/
+static u32 AXIS_wait_tx_vacancy(XLlFifo* FifoInstancePtr) {
+    // Returns the vacancy (in words) of the FIFO's TX, once there is some
+    u32 vacancy;
+
+    if (AXIS_polling) {
+        while ((vacancy = XLlFifo_iTxVacancy(FifoInstancePtr)) == 0) {}
+    }
+    else {
+        // Clear the flag BEFORE checking, a TC/TFPE interrupt in between then still wakes us up
+        TX_done = 0;
+        while ((vacancy = XLlFifo_iTxVacancy(FifoInstancePtr)) == 0) {
+            while (!TX_done) {
+                if (!HARD_idle()) asm("nop");
+            }
+            TX_done = 0;
+        }
+    }
+
+    return vacancy;
+}
+
 int AXIS_transmit(XLlFifo* FifoInstancePtr, int* HARD_input_memory) {
     // Writing into the FIFO Transmit Port Buffer (Input to PL Coprocessor)
-    for (int word_cnt=0; word_cnt < NUMBER_OF_INPUT_WORDS; word_cnt++) {
+    // Bulk writes of at most AXIS_TX_CHUNK_WORDS, each sized to the TX vacancy at the time, so nothing is ever dropped
+    // The whole batch is one packet, a single TxSetLen (one TLAST) after the last chunk, so it has to fit the TX FIFO (axi_stream.h)
+    int* batch = &HARD_input_memory[test_case_cnt*NUMBER_OF_INPUT_WORDS];
+    int num_words = NUMBER_OF_INPUT_WORDS;
+    u32 packet_words = 0;
+    u32 start_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0);
+
+    #ifdef MODEL_REGISTRY
+        // Opcode word leads the packet, B and C are left out when they are resident
+        u32 opcode_word = model_registry_opcode_word(&ModelRegistry, batch);
+        num_words = model_registry_num_words(opcode_word);
+        AXIS_wait_tx_vacancy(FifoInstancePtr);
+        XLlFifo_TxPutWord(FifoInstancePtr, opcode_word);
+        packet_words = 1;
+    #endif
 
-        // We set AXIS FIFO depth to 1024 (words) in Vivado, so it can comfortably fit NUMBER_OF_INPUT_WORDS
-        if( XLlFifo_iTxVacancy(FifoInstancePtr) ) {
-            XLlFifo_TxPutWord(FifoInstancePtr, (int)HARD_input_memory[word_cnt + test_case_cnt*NUMBER_OF_INPUT_WORDS]);
-        }
+    for (int word_cnt = 0; word_cnt < num_words; ) {
+        u32 chunk_words = AXIS_wait_tx_vacancy(FifoInstancePtr);
+        if (chunk_words > AXIS_TX_CHUNK_WORDS) chunk_words = AXIS_TX_CHUNK_WORDS;
+        if (chunk_words > num_words - word_cnt) chunk_words = num_words - word_cnt;
+
+        XLlFifo_Write(FifoInstancePtr, &batch[word_cnt], WORD_SIZE_IN_BYTES*chunk_words);
+        TRACE_DEBUG(TRACE_AXIS_TX_CHUNK, test_case_cnt, chunk_words, 0);
+
+        word_cnt += chunk_words;
+        packet_words += chunk_words;
+        AXIS_tx_chunks++;
     }
 
     // Kickoff transmission by declaring transmission length (in bytes)
-    XLlFifo_iTxSetLen(FifoInstancePtr, WORD_SIZE_IN_BYTES*NUMBER_OF_INPUT_WORDS);
+    XLlFifo_iTxSetLen(FifoInstancePtr, WORD_SIZE_IN_BYTES*packet_words);
+    AXIS_tx_words += packet_words;
+
+    AXIS_tx_time += XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0) - start_time;
 
-    #ifdef AXI_STREAM_POLLING_MODE
+    if (AXIS_polling) {
         // POLLING check for TX completion, by checking the TC flag of ISR register
         // How is this different from Interrupt mode? In Polling, the corresponding IER is NOT asserted
         // Thus we need to keep polling the TC flag
         while( !(XLlFifo_IsTxDone(FifoInstancePtr)) ) {}
         /* Transmission Complete */
         return XST_SUCCESS;
-    #else
+    }
+    else {
         // When transmission completes, it will raise an interrupt
         // Let our interrupt-handler settle it
         return XST_SUCCESS;
-    #endif
+    }
 }
 
-int AXIS_receive(XLlFifo* FifoInstancePtr) {
-    #ifdef AXI_STREAM_POLLING_MODE
+int AXIS_receive(XLlFifo* FifoInstancePtr, int batch) {
+    // Returns once the results of 'batch' are in HARD_result_memory
+    if (AXIS_polling) {
         /******************** Output from Coprocessor : Receive the Data Stream ***********************/
-        xil_printf(" Receiving data for test case %d ... \r\n", test_case_cnt);
-
         int timeout_count = TIMEOUT_VALUE;
         // Check the number of words (32-bit sized in our case) avail from FIFO's RX, subject to a timeout
         // It tells is the number of locations in use for data storage in the FIFO's RX, after the most recent transaction
@@ -251,10 +472,13 @@ int AXIS_receive(XLlFifo* FifoInstancePtr) {
             timeout_count--;
             if (timeout_count == 0)
             {
+                TRACE_ERROR(TRACE_AXIS_RX_TIMEOUT, packets_received, 0, 0);
                 xil_printf("Timeout while waiting for data ... \r\n");
                 return XST_FAILURE;
             }
         }
+        PROFILE_END(PROFILE_COMPUTE_WAIT);
+        TRACE_INFO(TRACE_AXIS_RX_POLL, packets_received, TIMEOUT_VALUE - timeout_count, 0);
 
         // For AXIS, one PACKET = sequence of DATA until TLAST
         // https://docs.xilinx.com/v/u/4.1-English/pg080-axi-fifo-mm-s -- Pg14, axi_str_rxd_tlast --> TLAST: Indicates boundary of a packet
@@ -264,10 +488,13 @@ int AXIS_receive(XLlFifo* FifoInstancePtr) {
         // https://docs.xilinx.com/r/en-US/pg080-axi-fifo-mm-s/Receive-Length-Register-RLR
         u32 num_bytes_in_packet = XLlFifo_iRxGetLen(FifoInstancePtr);    // Reads from RLR register
 
-        // Read one word at a time
+        // Read one word at a time, into the slot of the oldest batch without results (HARD_DOUBLE_BUFFER may have sent the next one)
+        PROFILE_BEGIN(PROFILE_RX);
         for (int word_cnt=0; word_cnt < num_bytes_in_packet/4; word_cnt++) {
-            HARD_result_memory[word_cnt+test_case_cnt*NUMBER_OF_OUTPUT_WORDS] = XLlFifo_RxGetWord(FifoInstancePtr);
+            HARD_result_memory[word_cnt+packets_received*NUMBER_OF_OUTPUT_WORDS] = XLlFifo_RxGetWord(FifoInstancePtr);
         }
+        packets_received++;
+        PROFILE_END(PROFILE_RX);
 
         int Status = XLlFifo_IsRxDone(FifoInstancePtr);
         if(Status != TRUE){
@@ -277,24 +504,146 @@ int AXIS_receive(XLlFifo* FifoInstancePtr) {
 
         return XST_SUCCESS;
         /* Reception Complete */
-    #else
-        while (packets_received != NUM_RX_PACKETS_EXPECTED) {
-            //asm("nop");
-            xil_printf("Busy RX\n");
+    }
+    else {
+        while (packets_received < (batch+1)*NUM_RX_PACKETS_EXPECTED) {
+            if (AXIS_rx_bottom_half(FifoInstancePtr)) continue;
+            if (HARD_idle()) continue;
+
+            // Nothing to copy out yet, sleep until the next interrupt
+            // IRQs are masked around the check, a descriptor pushed just before WFI still wakes it up (pending IRQ)
+            Xil_ExceptionDisable();
+            if (axis_rx_ring_empty()) wfi();
+            Xil_ExceptionEnable();
         }
 
         return XST_SUCCESS;
-    #endif
+    }
+}
+
+int AXIS_rx_bottom_half(XLlFifo* FifoInstancePtr) {
+    // Copies the packets out of the FIFO's RX for each descriptor the ISR handed over, returns the number of packets copied
+    axis_rx_descriptor descriptor;
+    int num_packets = 0;
+
+    while (axis_rx_ring_pop(&descriptor)) {
+        u32 delay = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0) - descriptor.irq_time;
+        if (delay > AXIS_rx_max_delay) AXIS_rx_max_delay = delay;
+        PROFILE_END(PROFILE_COMPUTE_WAIT);
+        PROFILE_BEGIN(PROFILE_RX);
+
+        // Check the number of words (32-bit sized in our case) avail from FIFO's RX
+        // Note this value is only updated after a packet is SUCCESSFULLY received
+        // Reads from RDRO register, https://docs.xilinx.com/r/en-US/pg080-axi-fifo-mm-s/Interrupt-Status-Register-ISR
+        while (XLlFifo_iRxOccupancy(FifoInstancePtr)) {
+            // We are expecting only one packet from testbench per testcase
+            u32 received_length = XLlFifo_iRxGetLen(FifoInstancePtr);
+
+            // Packets come back in the order the batches were sent, whichever batch is being sent meanwhile
+            int batch = packets_received/NUM_RX_PACKETS_EXPECTED;
+            XLlFifo_Read(FifoInstancePtr, &HARD_result_memory[batch*NUMBER_OF_OUTPUT_WORDS], received_length);
+            TRACE_INFO(TRACE_AXIS_RX_COPY, batch, received_length, delay);
+            packets_received++;
+            num_packets++;
+        }
+        PROFILE_END(PROFILE_RX);
+    }
+
+    return num_packets;
 }
 
 /********************************** HARD *********************************************/
+static int HARD_submit(int batch) {
+    TRACE_INFO(TRACE_BATCH_BEGIN, batch, 0, 0);
+
+    /*********** TX, Main Memory --> Coprocessor ************/
+    PROFILE_BEGIN(PROFILE_TX);
+    int Status = HARD_backend->submit(batch);
+    PROFILE_END(PROFILE_TX);
+    if (Status != XST_SUCCESS) {
+        xil_printf("%s TX error\n", HARD_backend->name);
+        return XST_FAILURE;
+    }
+    return XST_SUCCESS;
+}
+
+static int HARD_wait(int batch) {
+    /*********** RX, Coprocessor --> Main Memory ************/
+    PROFILE_BEGIN(PROFILE_COMPUTE_WAIT);
+    int Status = HARD_backend->wait(batch);
+    PROFILE_END(PROFILE_COMPUTE_WAIT);
+    if (Status != XST_SUCCESS) {
+        xil_printf("%s RX error\n", HARD_backend->name);
+        return XST_FAILURE;
+    }
+    TRACE_INFO(TRACE_BATCH_END, batch, 0, 0);
+    return XST_SUCCESS;
+}
+
+int HARD_processing(int num_batches) {
+    // Runs 'num_batches' batches of the ingest buffer through the coprocessor, results land in HARD_result_memory
+    TRACE_INFO(TRACE_HARD_BEGIN, num_batches, 0, 0);
+
+    #if !defined(HARD_HLS) && defined(AXI_DMA_INTERRUPT_MODE)
+        // ISRs keep MM2S/S2MM going batch after batch, so only the whole pipeline is timed
+        PROFILE_BEGIN(PROFILE_COMPUTE_WAIT);
+        if (dma_pipeline_start(&AxiDma, num_batches) != XST_SUCCESS) {
+            xil_printf("DMA pipeline start error\n");
+            return XST_FAILURE;
+        }
+        while (!dma_pipeline_done()) {
+            // Free to do other work, e.g prepare the next batch
+            if (!HARD_idle()) asm("nop");
+        }
+        PROFILE_END(PROFILE_COMPUTE_WAIT);
+        if (dma_pipeline_status() != XST_SUCCESS) {
+            xil_printf("DMA pipeline error\n");
+            return XST_FAILURE;
+        }
+    #elif !defined(HARD_HLS) && defined(AXI_DMA_SG_MODE)
+        // All batches go out as one BD chain per direction
+        PROFILE_BEGIN(PROFILE_COMPUTE_WAIT);
+        if (sg_transmit(&AxiDma, num_batches) != XST_SUCCESS) {
+            xil_printf("SG transfer error\n");
+            return XST_FAILURE;
+        }
+        PROFILE_END(PROFILE_COMPUTE_WAIT);
+    #else
+        // Batch by batch through the active backend (FIFO-poll, FIFO-IRQ, polling DMA, or SOFT with RUNTIME_BACKENDS)
+        #ifdef HARD_DOUBLE_BUFFER
+            // One batch ahead: batch+1 goes out before the results of batch are waited for
+            if (num_batches > 0 && HARD_submit(0) != XST_SUCCESS) return XST_FAILURE;
+            for (int batch = 0; batch < num_batches; batch++) {
+                if (batch+1 < num_batches && HARD_submit(batch+1) != XST_SUCCESS) return XST_FAILURE;
+                if (HARD_wait(batch) != XST_SUCCESS) return XST_FAILURE;
+            }
+        #else
+            for (int batch = 0; batch < num_batches; batch++) {
+                if (HARD_submit(batch) != XST_SUCCESS) return XST_FAILURE;
+                if (HARD_wait(batch) != XST_SUCCESS) return XST_FAILURE;
+            }
+        #endif
+    #endif
+
+    TRACE_INFO(TRACE_HARD_END, 0, 0, 0);
+    return XST_SUCCESS;
+}
+
+int HARD_idle() {
+    // Called while the CPU waits on the coprocessor, returns 1 if it found other work to do
+    #ifdef HETERO_SPLIT
+        return hetero_soft_step();
+    #else
+        return 0;
+    #endif
+}
 
 /********************************** SOFT *********************************************/
-void SOFT_processing(char* recv_a_matrix, char* recv_b_matrix, char* recv_c_matrix, 
-                    u8 (*SOFT_hidden_layer_neurons)[A_NUM_ROWS], u8* SOFT_output_layer_neurons) {
+void SOFT_processing(int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix, 
+                    u8 (*SOFT_hidden_layer_neurons)[A_NUM_ROWS], u8* SOFT_output_layer_neurons, int first_row, int end_row) {
     /**************************** COMPUTE HIDDEN LAYER ************************************/
-    // Iterate through 'A_NUM_ROWS' datapoints
-    for (int i = 0; i < A_NUM_ROWS; i++) {
+    // Iterate through datapoints 'first_row' to 'end_row'-1 (at most A_NUM_ROWS)
+    for (int i = first_row; i < end_row; i++) {
 
         // Weight of hidden layer neuron is maximally ((255*255)*(NUM_A_COLS) + 255)
         u32 sum_1 = 0;  // First neuron of hidden layer
@@ -319,8 +668,8 @@ void SOFT_processing(char* recv_a_matrix, char* recv_b_matrix, char* recv_c_matr
     }
 
     /**************************** COMPUTE OUTPUT LAYER ************************************/
-    // Iterate through 'A_NUM_ROWS' datapoints from BOTH neurons simultaneously
-    for (int i = 0; i < A_NUM_ROWS; i++) {
+    // Iterate through the same datapoints from BOTH neurons simultaneously
+    for (int i = first_row; i < end_row; i++) {
 
         u32 sum = 0;
 
@@ -339,12 +688,464 @@ void SOFT_processing(char* recv_a_matrix, char* recv_b_matrix, char* recv_c_matr
     }
 }
 
+void SOFT_cascade_processing(int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix, int* recv_s_matrix, int* recv_band,
+                             u8* SOFT_output_layer_neurons, u8* SOFT_decided_stage, int first_row, int end_row) {
+    #ifdef CASCADE_MODE
+    /**************************** STAGE ONE: LINEAR SCREEN ************************************/
+    // Confident datapoints are decided here, the uncertain ones are compacted for the full MLP
+    // Datapoints may come in several calls (first_row > 0), compaction then carries on after the previous ones
+    if (first_row == 0) SOFT_num_full_rows = 0;
+    int first_full_row = SOFT_num_full_rows;
+
+    for (int i = first_row; i < end_row; i++) {
+        u32 score = 0;
+
+        for (int j = 0; j < A_NUM_COLS; j++) {
+            u8 datapoint = recv_a_matrix[(i*A_NUM_COLS) + (j)];
+            score += datapoint * recv_s_matrix[S_DISREGARD_BIAS_TERM + j];
+        }
+        score += recv_s_matrix[0];
+        score = score >> NUM_FRACTIONAL_BITS;
+
+        if (recv_band[0] <= score && score <= recv_band[1]) {
+            SOFT_decided_stage[i] = CASCADE_STAGE_FULL;
+            for (int j = 0; j < A_NUM_COLS; j++) {
+                SOFT_full_a_matrix[(SOFT_num_full_rows*A_NUM_COLS) + j] = recv_a_matrix[(i*A_NUM_COLS) + j];
+            }
+            SOFT_full_rows[SOFT_num_full_rows] = i;
+            SOFT_num_full_rows++;
+        }
+        else {
+            SOFT_decided_stage[i] = CASCADE_STAGE_SCREEN;
+            SOFT_output_layer_neurons[i] = (score > 255) ? 255 : score;
+        }
+    }
+
+    /**************************** STAGE TWO: FULL MLP ************************************/
+    SOFT_MLP(SOFT_full_a_matrix, recv_b_matrix, recv_c_matrix, SOFT_hidden_layer_neurons, SOFT_full_output, first_full_row, SOFT_num_full_rows);
+
+    for (int k = first_full_row; k < SOFT_num_full_rows; k++) {
+        SOFT_output_layer_neurons[SOFT_full_rows[k]] = SOFT_full_output[k];
+    }
+    #endif
+}
+
 u8 sigmoid_function(u8 sigmoid_LUT_index) {
     return sigmoid_LUT[sigmoid_LUT_index];
 }
 
+/********************************** Streaming *********************************************/
+#ifdef UART_RX_INTERRUPT_MODE
+static int stream_dispatch(int first_row, int end_row) {
+    // SOFT computes datapoints 'first_row' to 'end_row'-1, then their results go back through the UART
+    // A HARD transaction always carries the whole batch (weights included), so HARD only runs once the last datapoint is in
+    u32 start_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0);
+
+    #ifdef CASCADE_MODE
+        SOFT_cascade_processing(recv_a_matrix, recv_b_matrix, recv_c_matrix, recv_s_matrix, recv_band,
+                                SOFT_output_layer_neurons, SOFT_decided_stage, first_row, end_row);
+    #else
+        SOFT_MLP(recv_a_matrix, recv_b_matrix, recv_c_matrix, SOFT_hidden_layer_neurons, SOFT_output_layer_neurons,
+                        first_row, end_row);
+    #endif
+    u32 soft_done_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0);
+
+    STREAM_soft_time += soft_done_time - start_time;
+    STREAM_num_dispatches++;
+    for (int i = first_row; i < end_row; i++) {
+        // Same format as the coprocessor's results
+        #ifdef CASCADE_MODE
+            STREAM_result_memory[i] = (SOFT_decided_stage[i] << CASCADE_STAGE_SHIFT) | SOFT_output_layer_neurons[i];
+        #else
+            STREAM_result_memory[i] = SOFT_output_layer_neurons[i];
+        #endif
+        STREAM_result_time[i] = soft_done_time;
+    }
+
+    send_results(UART_BASEADDR, &STREAM_result_memory[first_row], first_row, end_row - first_row);
+
+    return XST_SUCCESS;
+}
+
+int stream_processing() {
+    // Event loop: the ISR keeps filling the ring, the parser reports each completed datapoint
+    // Once the weights are in, datapoints go out in micro-batches of STREAM_MICRO_BATCH_ROWS
+    int weights_ready = 0;
+    int rows_received = 0;
+    int rows_dispatched = 0;
+
+    uart_parser_init(&UartParser, UART_RX_FIRST_VALUE);
+    start_uart_rx_interrupt(&Uart_Ps);
+
+    while (rows_dispatched < A_NUM_ROWS) {
+        int event = uart_rx_next_event(&UartParser, HARD_input_memory);
+
+        // A dropped byte shifts every later value, nothing to recover from
+        if (uart_rx_num_overflows() != 0) {
+            xil_printf("UART RX overrun\n");
+            return XST_FAILURE;
+        }
+
+        // Timestamps run from the first value received
+        if (UartParser.valid_recv_count > 0 && !STREAM_timer_started) {
+            timer_restart(TimerCtrInstancePtr);
+            STREAM_start_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0);
+            STREAM_timer_started = 1;
+        }
+
+        if (event == UART_EVENT_WEIGHTS_READY) {
+            weights_ready = 1;
+        }
+        else if (event == UART_EVENT_ROW_COMPLETE) {
+            STREAM_row_time[UartParser.row] = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0);
+            rows_received++;
+        }
+        else {
+            // Nothing new in the ring yet
+            asm("nop");
+            continue;
+        }
+
+        // Rows arrive in order, so the received ones are always rows_dispatched to rows_received-1
+        if (weights_ready && (rows_received - rows_dispatched >= STREAM_MICRO_BATCH_ROWS || rows_received == A_NUM_ROWS)) {
+            if (stream_dispatch(rows_dispatched, rows_received) != XST_SUCCESS) return XST_FAILURE;
+            rows_dispatched = rows_received;
+        }
+    }
+
+    // HARD runs the whole batch in one transaction, verify() checks the streamed SOFT results against it
+    u32 start_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0);
+    if (HARD_processing(1) != XST_SUCCESS) return XST_FAILURE;
+    STREAM_hard_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0) - start_time;
+
+    return XST_SUCCESS;
+}
+
+void stream_print_latency() {
+    // Per datapoint, from its last byte being parsed to its result being available
+    u32 min_latency = 0xFFFFFFFF;
+    u32 max_latency = 0;
+    u32 sum_latency = 0;
+
+    for (int i = 0; i < A_NUM_ROWS; i++) {
+        u32 latency = STREAM_result_time[i] - STREAM_row_time[i];
+
+        if (latency < min_latency) min_latency = latency;
+        if (latency > max_latency) max_latency = latency;
+        sum_latency += latency;
+    }
+
+    xil_printf("Row latency (last byte to result): min %d, avg %d, max %d\n", min_latency, sum_latency/A_NUM_ROWS, max_latency);
+    xil_printf("Last datapoint received at %d, first result at %d\n", STREAM_row_time[A_NUM_ROWS-1] - STREAM_start_time,
+               STREAM_result_time[0] - STREAM_start_time);
+}
+#endif
+
+/********************************** Heterogeneous split *********************************************/
+#ifdef HETERO_SPLIT
+int hetero_soft_step() {
+    // Next HETERO_STEP_ROWS rows of the SOFT share, returns 0 once the whole share is done
+    if (HETERO_soft_batch >= NUMBER_OF_TEST_VECTORS) return 0;
+
+    int* batch = &HARD_input_memory[HETERO_soft_batch*NUMBER_OF_INPUT_WORDS];
+    int first_row = HETERO_soft_row;
+    int end_row = (first_row + HETERO_STEP_ROWS < A_NUM_ROWS) ? first_row + HETERO_STEP_ROWS : A_NUM_ROWS;
+    u32 start_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0);
+
+    SOFT_MLP(batch + A_OFFSET, batch + B_OFFSET, batch + C_OFFSET, HETERO_hidden_layer_neurons, HETERO_output_layer_neurons, first_row, end_row);
+
+    // Merge: results go exactly where the coprocessor would have put them
+    for (int i = first_row; i < end_row; i++) {
+        HARD_result_memory[HETERO_soft_batch*NUMBER_OF_OUTPUT_WORDS + i] = HETERO_output_layer_neurons[i];
+    }
+    HETERO_soft_time += XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0) - start_time;
+
+    HETERO_soft_row = end_row;
+    if (HETERO_soft_row == A_NUM_ROWS) {
+        HETERO_soft_batch++;
+        HETERO_soft_row = 0;
+    }
+    return 1;
+}
+
+int hetero_processing() {
+    // One workload: HARD takes batches 0 to hard_batches-1, SOFT the rest
+    // SOFT steps fill the waits of HARD_processing, whatever is left of the SOFT share runs once HARD is done
+    int hard_batches = hetero_plan(&HeteroScheduler);
+    HETERO_soft_batch = hard_batches;
+    HETERO_soft_row = 0;
+    HETERO_soft_time = 0;
+
+    u32 start_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0);
+    if (HARD_processing(hard_batches) != XST_SUCCESS) return XST_FAILURE;
+    u32 hard_done_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0);
+
+    while (hetero_soft_step()) {}
+    u32 end_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0);
+
+    hetero_update(&HeteroScheduler, hard_done_time - start_time, (NUMBER_OF_TEST_VECTORS - hard_batches)*A_NUM_ROWS,
+                  HETERO_soft_time, end_time - start_time);
+    return XST_SUCCESS;
+}
+#endif
+
+/********************************** Benchmark *********************************************/
+#ifdef BENCHMARK_MODE
+static int bench_soft() {
+    #ifdef CASCADE_MODE
+        SOFT_cascade_processing(recv_a_matrix, recv_b_matrix, recv_c_matrix, recv_s_matrix, recv_band,
+                                SOFT_output_layer_neurons, SOFT_decided_stage, 0, A_NUM_ROWS);
+    #else
+        SOFT_MLP(recv_a_matrix, recv_b_matrix, recv_c_matrix, SOFT_hidden_layer_neurons, SOFT_output_layer_neurons, 0, A_NUM_ROWS);
+    #endif
+    return XST_SUCCESS;
+}
+
+static int bench_hard() {
+    return HARD_processing(1);
+}
+
+// Every backend of this build, the HARD transport is chosen in main.h
+static const bench_backend bench_backends[] = {
+    {"SOFT", bench_soft, 1},
+    #ifdef HARD_HLS
+        {"HLS-FIFO", bench_hard, 1},
+    #else
+        {"HDL-DMA", bench_hard, 1},
+    #endif
+    #ifdef HETERO_SPLIT
+        {"HETERO", hetero_processing, NUMBER_OF_TEST_VECTORS},
+    #endif
+};
+
+int bench_run_all() {
+    // Replays the received batch, results are left as the last run wrote them, verify() still checks them
+    for (int backend = 0; backend < sizeof(bench_backends)/sizeof(bench_backends[0]); backend++) {
+        if (bench_run(TimerCtrInstancePtr, &bench_backends[backend]) != XST_SUCCESS) return XST_FAILURE;
+    }
+
+    return XST_SUCCESS;
+}
+#endif
+
+/********************************** Backends *********************************************/
+#ifdef RUNTIME_BACKENDS
+static int backend_nop() {
+    return XST_SUCCESS;
+}
+
+static int soft_backend_submit(int batch) {
+    // Same results as the coprocessor would write, the reference of verify() is left alone
+    int* inputs = &HARD_input_memory[batch*NUMBER_OF_INPUT_WORDS];
+    int* results = &HARD_result_memory[batch*NUMBER_OF_OUTPUT_WORDS];
+
+    #ifdef CASCADE_MODE
+        SOFT_cascade_processing(inputs + A_OFFSET, inputs + B_OFFSET, inputs + C_OFFSET, inputs + S_OFFSET, inputs + BAND_OFFSET,
+                                BACKEND_output_layer_neurons, BACKEND_decided_stage, 0, A_NUM_ROWS);
+        for (int i = 0; i < A_NUM_ROWS; i++) {
+            results[i] = (BACKEND_decided_stage[i] << CASCADE_STAGE_SHIFT) | BACKEND_output_layer_neurons[i];
+        }
+    #else
+        SOFT_MLP(inputs + A_OFFSET, inputs + B_OFFSET, inputs + C_OFFSET, BACKEND_hidden_layer_neurons, BACKEND_output_layer_neurons, 0, A_NUM_ROWS);
+        for (int i = 0; i < A_NUM_ROWS; i++) {
+            results[i] = BACKEND_output_layer_neurons[i];
+        }
+    #endif
+    return XST_SUCCESS;
+}
+
+static int soft_backend_wait(int batch) {
+    // Submit already wrote the results
+    return XST_SUCCESS;
+}
+#endif
+
+#ifdef BACKEND_FIFO_USED
+static int fifo_backend_init(int polling) {
+    if (init_base_FIFO_system(FIFODeviceId, FifoInstancePtr) == XST_FAILURE) {
+        xil_printf("Failed base FIFO initialization\n");
+        return XST_FAILURE;
+    }
+    #ifdef MODEL_REGISTRY
+        model_registry_invalidate(&ModelRegistry);
+    #endif
+
+    AXIS_polling = polling;
+    if (!polling) {
+        // Enable AXIS_FIFO with choice of interrupts
+        XLlFifo_IntEnable(FifoInstancePtr, XLLF_INT_TC_MASK|XLLF_INT_TFPE_MASK|XLLF_INT_RC_MASK);
+    }
+    return XST_SUCCESS;
+}
+
+static int fifo_poll_backend_init() {
+    return fifo_backend_init(1);
+}
+
+static int fifo_irq_backend_init() {
+    return fifo_backend_init(0);
+}
+
+static int fifo_backend_submit(int batch) {
+    // TX flag is raised by the ISR once per batch, packets are counted from batch 0 on
+    test_case_cnt = batch;
+    TX_done = 0;
+    if (batch == 0) packets_received = 0;
+
+    if (AXIS_transmit(FifoInstancePtr, HARD_input_memory) != XST_SUCCESS) return XST_FAILURE;
+
+    // Interrupt mode: Do other work while waiting for TX completion
+    if (!AXIS_polling) {
+        while (!TX_done) {
+            if (!HARD_idle()) asm("nop");
+        }
+    }
+    return XST_SUCCESS;
+}
+
+static int fifo_backend_wait(int batch) {
+    // Polling mode: Polling read of RDRO register
+    // Interrupt mode: Only read RDRO register when RC flag is raised
+    return AXIS_receive(FifoInstancePtr, batch);
+}
+
+static int fifo_backend_teardown() {
+    XLlFifo_IntDisable(FifoInstancePtr, XLLF_INT_ALL_MASK);
+    XLlFifo_IntClear(FifoInstancePtr, XLLF_INT_ALL_MASK);
+    return XST_SUCCESS;
+}
+#endif
+
+#ifdef BACKEND_DMA_USED
+static int dma_backend_init() {
+    if (init_DMA_system(DMA_DEV_ID, &AxiDma) == XST_FAILURE) {
+        xil_printf("Failed DMA initialization\n");
+        return XST_FAILURE;
+    }
+    #ifdef MODEL_REGISTRY
+        model_registry_invalidate(&ModelRegistry);
+    #endif
+    DMA_rx_unarmed = -1;
+    return XST_SUCCESS;
+}
+
+static int dma_backend_submit(int batch) {
+    // Results of the batch sent before go into S2MM first (HARD_DOUBLE_BUFFER), the coprocessor only takes
+    // this batch once they have left, so MM2S would never complete otherwise
+    if (DMA_rx_unarmed >= 0) {
+        if (s2mm_start(&AxiDma, DMA_rx_unarmed) != XST_SUCCESS) return XST_FAILURE;
+        DMA_rx_unarmed = -1;
+    }
+
+    #ifdef MODEL_REGISTRY
+        // Opcode word in a transfer of its own, then the batch, without B and C when they are resident
+        int* inputs = &HARD_input_memory[batch*NUMBER_OF_INPUT_WORDS];
+        *DMA_opcode_word = model_registry_opcode_word(&ModelRegistry, inputs);
+        if (mm2s_transmit_words(&AxiDma, DMA_opcode_word, 1) != XST_SUCCESS) return XST_FAILURE;
+        if (mm2s_transmit_words(&AxiDma, inputs, model_registry_num_words(*DMA_opcode_word)) != XST_SUCCESS) return XST_FAILURE;
+    #else
+        if (mm2s_transmit(&AxiDma, batch) != XST_SUCCESS) return XST_FAILURE;
+    #endif
+    DMA_rx_unarmed = batch;
+    return XST_SUCCESS;
+}
+
+static int dma_backend_wait(int batch) {
+    if (DMA_rx_unarmed == batch) {
+        if (s2mm_start(&AxiDma, batch) != XST_SUCCESS) return XST_FAILURE;
+        DMA_rx_unarmed = -1;
+    }
+    return s2mm_finish(&AxiDma, batch);
+}
+
+static int dma_backend_teardown() {
+    XAxiDma_Reset(&AxiDma);
+    for (int timeout = TIMEOUT_VALUE; !XAxiDma_ResetIsDone(&AxiDma); timeout--) {
+        if (timeout == 0) return XST_FAILURE;
+    }
+    return XST_SUCCESS;
+}
+#endif
+
+// Every backend of this build, the normal run goes through BACKEND_DEFAULT
+static const infer_backend infer_backends[] = {
+    #ifdef RUNTIME_BACKENDS
+        {"SOFT", BACKEND_SOFT, backend_nop, soft_backend_submit, soft_backend_wait, backend_nop},
+    #endif
+    #ifdef BACKEND_FIFO_POLL_USED
+        {"FIFO-poll", BACKEND_FIFO_POLL, fifo_poll_backend_init, fifo_backend_submit, fifo_backend_wait, fifo_backend_teardown},
+    #endif
+    #ifdef BACKEND_FIFO_IRQ_USED
+        {"FIFO-IRQ", BACKEND_FIFO_IRQ, fifo_irq_backend_init, fifo_backend_submit, fifo_backend_wait, fifo_backend_teardown},
+    #endif
+    #ifdef BACKEND_DMA_USED
+        {"DMA", BACKEND_DMA, dma_backend_init, dma_backend_submit, dma_backend_wait, dma_backend_teardown},
+    #endif
+};
+#define NUM_INFER_BACKENDS (sizeof(infer_backends)/sizeof(infer_backends[0]))
+
+#ifdef RUNTIME_BACKENDS
+int backend_session() {
+    // A/B of the transports on the workload just received: one run per command, cycles and mismatches against SOFT
+    backend_print_commands(infer_backends, NUM_INFER_BACKENDS);
+
+    while (1) {
+        char command = receive_command(UART_BASEADDR);
+        if (command == BACKEND_QUIT) return XST_SUCCESS;
+
+        const infer_backend* backend = backend_find(infer_backends, NUM_INFER_BACKENDS, command);
+        if (backend == NULL) {
+            xil_printf("Unknown backend '%c'\n", command);
+            continue;
+        }
+        if (backend != HARD_backend && backend_switch(&HARD_backend, backend) != XST_SUCCESS) return XST_FAILURE;
+
+        for (int word_cnt = 0; word_cnt < NUMBER_OF_TEST_VECTORS*NUMBER_OF_OUTPUT_WORDS; word_cnt++) {
+            HARD_result_memory[word_cnt] = 0;
+        }
+
+        u32 start_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0);
+        if (HARD_processing(NUMBER_OF_TEST_VECTORS) != XST_SUCCESS) return XST_FAILURE;
+        u32 run_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0) - start_time;
+
+        xil_printf("Backend %s: %d batches in %d cycles, %d mismatches\n", backend->name, NUMBER_OF_TEST_VECTORS, run_time, count_mismatches());
+
+        #ifdef BENCHMARK_MODE
+            bench_backend bench = {backend->name, bench_hard, 1};
+            if (bench_run(TimerCtrInstancePtr, &bench) != XST_SUCCESS) return XST_FAILURE;
+        #endif
+    }
+}
+#endif
+
 /********************************** Generic *********************************************/
 int initialization() {
+    // Buffers first, everything after may touch them
+    if (dma_arena_init() == XST_FAILURE) {
+        xil_printf("Failed DMA arena initialization\n");
+        return XST_FAILURE;
+    }
+    HARD_input_memory = dma_arena_alloc(NUMBER_OF_TEST_VECTORS*NUMBER_OF_INPUT_WORDS*WORD_SIZE_IN_BYTES);
+    HARD_result_memory = dma_arena_alloc(NUMBER_OF_TEST_VECTORS*NUMBER_OF_OUTPUT_WORDS*WORD_SIZE_IN_BYTES);
+    if (HARD_input_memory == NULL || HARD_result_memory == NULL) {
+        xil_printf("DMA arena too small for the buffers\n");
+        return XST_FAILURE;
+    }
+    #ifdef MODEL_REGISTRY
+        DMA_opcode_word = dma_arena_alloc(WORD_SIZE_IN_BYTES);
+        if (DMA_opcode_word == NULL) {
+            xil_printf("DMA arena too small for the buffers\n");
+            return XST_FAILURE;
+        }
+    #endif
+    recv_a_matrix = HARD_input_memory + A_OFFSET;
+    recv_b_matrix = HARD_input_memory + B_OFFSET;
+    recv_c_matrix = HARD_input_memory + C_OFFSET;
+    #ifdef CASCADE_MODE
+        recv_s_matrix = HARD_input_memory + S_OFFSET;
+        recv_band = HARD_input_memory + BAND_OFFSET;
+    #endif
+
     if (init_UART(&Uart_Ps) == XST_FAILURE) {
         xil_printf("Failed UART initialization\n");
         return XST_FAILURE;
@@ -356,39 +1157,137 @@ int initialization() {
         return XST_FAILURE;
     }
 
-    #ifndef HARD_HLS
-        if (init_DMA_system(DMA_DEV_ID, &AxiDma) == XST_FAILURE) {
-            xil_printf("Failed DMA initialization\n");
+    #ifdef PROFILE
+        if (profile_init(TimerCtrInstancePtr) == XST_FAILURE) {
+            xil_printf("Failed profiling initialization\n");
             return XST_FAILURE;
         }
-    #else
-        if (init_base_FIFO_system(FIFODeviceId, FifoInstancePtr) == XST_FAILURE) {
-            xil_printf("Failed base FIFO initialization\n");
+    #elif defined(BENCHMARK_MODE)
+        if (init_timer_cascade(TimerCtrInstancePtr) == XST_FAILURE) {
+            xil_printf("Failed 64-bit timer initialization\n");
             return XST_FAILURE;
         }
+    #endif
 
-        #ifndef AXI_STREAM_POLLING_MODE
-            if (init_interrupts(&IntC, FifoInstancePtr, TimerCtrInstancePtr) != XST_SUCCESS) {
-                xil_printf("Failed interrupt initialization\n");
-                return XST_FAILURE;
-            } else {
-                // Enable AXIS_FIFO with choice of interrupts
-                XLlFifo_IntEnable(FifoInstancePtr, XLLF_INT_TC_MASK|XLLF_INT_RC_MASK);
-            }
-        #endif
+    #ifdef RESULT_CACHE
+        result_cache_init(&ResultCache);
     #endif
 
+    #ifdef MODEL_REGISTRY
+        model_registry_init(&ModelRegistry);
+    #endif
+
+    #ifdef HETERO_SPLIT
+        hetero_init(&HeteroScheduler, NUMBER_OF_TEST_VECTORS);
+    #endif
+
+    #ifdef SOFT_PARALLEL
+        if (soft_parallel_init() == XST_FAILURE) {
+            xil_printf("Failed SOFT cores initialization\n");
+            return XST_FAILURE;
+        }
+    #endif
+
+    #ifdef INTERRUPTS_USED
+        if (init_interrupts(&IntC, FifoInstancePtr, TimerCtrInstancePtr) != XST_SUCCESS) {
+            xil_printf("Failed interrupt initialization\n");
+            return XST_FAILURE;
+        }
+    #endif
+
+    // Transport last, its interrupts are connected by now
+    if (backend_switch(&HARD_backend, backend_find(infer_backends, NUM_INFER_BACKENDS, BACKEND_DEFAULT)) != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+
     return XST_SUCCESS;
 }
 
+static int expected_result(int word_cnt) {
+    // Every batch is a copy of the received one (NUMBER_OF_TEST_VECTORS > 1)
+    int row = word_cnt % NUMBER_OF_OUTPUT_WORDS;
+    #ifdef CASCADE_MODE
+        // Coprocessor tags each result with the stage that decided it
+        return (SOFT_decided_stage[row] << CASCADE_STAGE_SHIFT) | SOFT_output_layer_neurons[row];
+    #else
+        return SOFT_output_layer_neurons[row];
+    #endif
+}
+
+int count_mismatches() {
+    int num_mismatches = 0;
+
+    for (int word_cnt=0; word_cnt < NUMBER_OF_TEST_VECTORS*NUMBER_OF_OUTPUT_WORDS; word_cnt++) {
+        if (HARD_result_memory[word_cnt] != expected_result(word_cnt)) num_mismatches++;
+    }
+    return num_mismatches;
+}
+
+#ifdef VERIFY_CHECKSUM
+static u64 result_digest(int* results) {
+    // Fletcher style running sum of a batch of results, two adds per word
+    // The sum of sums weighs each word by its position, so results swapped between datapoints show too
+    u32 sum = 0;
+    u32 sum_of_sums = 0;
+
+    for (int row = 0; row < NUMBER_OF_OUTPUT_WORDS; row++) {
+        sum += (u32)results[row];
+        sum_of_sums += sum;
+    }
+    return ((u64)sum_of_sums << 32) | sum;
+}
+
+int verify() {
+    // Every batch is checked against the digest of the expected results, they are the same for all batches
+    int expected[NUMBER_OF_OUTPUT_WORDS];
+    int num_failed_batches = 0;
+    int num_mismatches = 0;
+
+    xil_printf(" Comparing checksums ...\r\n");
+    for (int row = 0; row < NUMBER_OF_OUTPUT_WORDS; row++) {
+        expected[row] = expected_result(row);
+    }
+    u64 expected_digest = result_digest(expected);
+
+    for (int batch = 0; batch < NUMBER_OF_TEST_VECTORS; batch++) {
+        int* results = &HARD_result_memory[batch*NUMBER_OF_OUTPUT_WORDS];
+        if (result_digest(results) == expected_digest) continue;
+
+        // Digests differ, find out where
+        num_failed_batches++;
+        for (int row = 0; row < NUMBER_OF_OUTPUT_WORDS; row++) {
+            if (results[row] == expected[row]) continue;
+
+            TRACE_ERROR(TRACE_VERIFY_MISMATCH, batch*NUMBER_OF_OUTPUT_WORDS + row, results[row], expected[row]);
+            if (num_mismatches < VERIFY_MAX_REPORTED) {
+                xil_printf("Batch %d, datapoint %d: %d, expected %d\n", batch, row, results[row], expected[row]);
+            }
+            num_mismatches++;
+        }
+    }
+
+    if (num_failed_batches != 0) {
+        xil_printf("Verification fail: %d of %d batches, %d mismatches\n", num_failed_batches, NUMBER_OF_TEST_VECTORS, num_mismatches);
+        return XST_FAILURE;
+    }
+
+    xil_printf("Verification success\n");
+    return XST_SUCCESS;
+}
+#else
 int verify() {
 	int success = 1;
 
 	// Compare received HDL/HLS data with our software computation
 	xil_printf(" Comparing data ...\r\n");
 	for (int word_cnt=0; word_cnt < NUMBER_OF_TEST_VECTORS*NUMBER_OF_OUTPUT_WORDS; word_cnt++) {
-        xil_printf("%d ", HARD_result_memory[word_cnt]);
-		success = success & (HARD_result_memory[word_cnt] == SOFT_output_layer_neurons[word_cnt]);
+        // Results already went back with send_results, the trace keeps them (TRACE_LEVEL_DEBUG) without holding up the UART
+        int expected = expected_result(word_cnt);
+        TRACE_DEBUG(TRACE_VERIFY_WORD, word_cnt, HARD_result_memory[word_cnt], expected);
+        if (HARD_result_memory[word_cnt] != expected) {
+            TRACE_ERROR(TRACE_VERIFY_MISMATCH, word_cnt, HARD_result_memory[word_cnt], expected);
+            success = 0;
+        }
 	}
 
 	if (success != 1){
@@ -398,4 +1297,5 @@ int verify() {
 
     xil_printf("Verification success\n");
     return XST_SUCCESS;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
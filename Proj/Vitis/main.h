@@ -4,14 +4,25 @@
 //  - AXI-Stream (Interrupt) connected HLS (HARD_HLS)
 #define HARD_HLS
 
-#define NUM_FRACTIONAL_BITS 8
-#define NUM_WEIGHTS_INPUT_TO_HIDDEN 8    // 7(weight connections) + 1(bias)
-#define NUM_WEIGHTS_HIDDEN_TO_OUTPUT 3   // 2(weight connections) + 1(bias)
-#define NUM_NEURONS_INPUT_LAYER 7
-#define NUM_NEURONS_HIDDEN_LAYER 2
-#define NUM_NEURONS_OUTPUT_LAYER 1
+// Serve repeated datapoints from a result cache, only misses are sent to SOFT and HARD
+//#define RESULT_CACHE
 
-#define TIMEOUT_VALUE 1<<20
+// Verify each batch by a running sum against the one of the SOFT results, only a batch whose digest differs is compared word by word
+// At most VERIFY_MAX_REPORTED mismatches are printed, the rest are only counted
+//#define VERIFY_CHECKSUM
+#define VERIFY_MAX_REPORTED 8
+
+// Batch N+1 is sent while the results of batch N are still coming back, per batch time approaches max(TX, RX) instead of TX+RX
+// Every batch already has its own slot in HARD_input_memory and HARD_result_memory, the next one is the other half of the ping-pong
+// FIFO: TX of N+1 starts once N is consumed (TX done), its results wait in the FIFO's RX. DMA: S2MM of N is armed before MM2S of N+1
+//#define HARD_DOUBLE_BUFFER
+
+#define TIMEOUT_VALUE (1<<20)
+
+// UART_RX_INTERRUPT_MODE: datapoints are dispatched to SOFT and HARD in micro-batches of this many rows
+#ifndef STREAM_MICRO_BATCH_ROWS
+    #define STREAM_MICRO_BATCH_ROWS 8
+#endif
 
 /******************************** INCLUDES *************************************/
 #include "uart.h"
@@ -19,22 +30,116 @@
 #include "interrupts.h"
 #include "axi_stream.h"
 #include "axi_dma.h"
+#include "result_cache.h"
+#include "soft_simd.h"
+#include "soft_parallel.h"
+#include "hetero.h"
+#include "profile.h"
+#include "bench.h"
+#include "backend.h"
+#include "trace.h"
+#include "crc32.h"
+#include "model_registry.h"
+
+#if defined(RESULT_CACHE) && defined(CASCADE_MODE)
+    #error "RESULT_CACHE does not keep the stage tags of CASCADE_MODE"
+#endif
+#if defined(UART_RX_INTERRUPT_MODE) && (defined(RESULT_CACHE) || defined(UART_BINARY_PROTOCOL))
+    #error "UART_RX_INTERRUPT_MODE computes datapoints as they arrive, RESULT_CACHE needs them all, UART_BINARY_PROTOCOL has its own receiver"
+#endif
+#if defined(HETERO_SPLIT) && (defined(UART_RX_INTERRUPT_MODE) || defined(RESULT_CACHE) || defined(CASCADE_MODE))
+    #error "HETERO_SPLIT only merges whole batches of full MLP results"
+#endif
+#if defined(RUNTIME_BACKENDS) && (defined(AXI_DMA_SG_MODE) || defined(AXI_DMA_INTERRUPT_MODE))
+    #error "RUNTIME_BACKENDS runs the DMA batch by batch, in polling mode"
+#endif
+#if defined(RUNTIME_BACKENDS) && (defined(UART_RX_INTERRUPT_MODE) || defined(RESULT_CACHE))
+    #error "RUNTIME_BACKENDS replays the whole received workload, and reads its commands by polling the UART"
+#endif
+#if defined(MODEL_REGISTRY) && (defined(CASCADE_MODE) || defined(AXI_DMA_SG_MODE) || defined(AXI_DMA_INTERRUPT_MODE))
+    #error "MODEL_REGISTRY leads each batch with its own opcode word, batch by batch, and the coprocessor keeps no screen weights resident"
+#endif
+// The opcode word only means something to the HLS coprocessor built with ONLINE_TRAINING (Proj/HLS), which the PS cannot check
+#if defined(MODEL_REGISTRY) && !defined(HARD_HLS)
+    #error "MODEL_REGISTRY needs HARD_HLS, with the coprocessor built with ONLINE_TRAINING"
+#endif
+#if defined(HETERO_SPLIT) && NUMBER_OF_TEST_VECTORS < 2
+    #error "HETERO_SPLIT shares the batches of a workload, set NUMBER_OF_TEST_VECTORS to 2 or more"
+#endif
+
+// Full MLP of SOFT, vectorized with SOFT_SIMD (soft_simd.h), spread over the cores with SOFT_PARALLEL (soft_parallel.h)
+#if defined(SOFT_PARALLEL)
+    #define SOFT_MLP SOFT_processing_parallel
+#elif defined(SOFT_SIMD)
+    #define SOFT_MLP SOFT_processing_simd
+#else
+    #define SOFT_MLP SOFT_processing
+#endif
+
+// Transports in this build (backend.h), RUNTIME_BACKENDS has all of them
+#if defined(RUNTIME_BACKENDS) || (defined(HARD_HLS) && defined(AXI_STREAM_POLLING_MODE))
+    #define BACKEND_FIFO_POLL_USED
+#endif
+#if defined(RUNTIME_BACKENDS) || (defined(HARD_HLS) && !defined(AXI_STREAM_POLLING_MODE))
+    #define BACKEND_FIFO_IRQ_USED
+#endif
+#if defined(RUNTIME_BACKENDS) || !defined(HARD_HLS)
+    #define BACKEND_DMA_USED
+#endif
+#if defined(BACKEND_FIFO_POLL_USED) || defined(BACKEND_FIFO_IRQ_USED)
+    #define BACKEND_FIFO_USED
+#endif
+// Backend the normal run goes through
+#if !defined(HARD_HLS)
+    #define BACKEND_DEFAULT BACKEND_DMA
+#elif defined(AXI_STREAM_POLLING_MODE)
+    #define BACKEND_DEFAULT BACKEND_FIFO_POLL
+#else
+    #define BACKEND_DEFAULT BACKEND_FIFO_IRQ
+#endif
+
+// init_interrupts is needed as soon as one peripheral is interrupt driven
+#if defined(BACKEND_FIFO_IRQ_USED) || (!defined(HARD_HLS) && defined(AXI_DMA_INTERRUPT_MODE)) || defined(UART_INTERRUPTS_USED)
+    #define INTERRUPTS_USED
+#endif
 
 /******************************* VARIABLES *************************************/
 // UART
 XUartPs Uart_Ps;    // Instance of UART Driver. Passed around by functions to refer to SPECIFIC driver instance
-char recv_a_matrix[A_NUM_ROWS*A_NUM_COLS] = {0};
-char recv_b_matrix[B_NUM_ROWS*B_NUM_COLS] = {0};
-char recv_c_matrix[C_NUM_ROWS*C_NUM_COLS] = {0};
+
+// Ingest buffer: UART parser writes each value once, already in the coprocessor layout (one word per value)
+// DMA/FIFO send it as is, SOFT reads the matrices in place through the views below
+// Comes from the DMA arena (dma_arena.h), set up with the views by initialization()
+int* HARD_input_memory;
+int* recv_a_matrix;
+int* recv_b_matrix;
+int* recv_c_matrix;
 int trans_res_matrix[A_NUM_ROWS*B_NUM_COLS] = {0};
+#ifdef UART_RX_INTERRUPT_MODE
+    uart_parser UartParser;
+    int STREAM_timer_started = 0;
+    u32 STREAM_start_time = 0;
+    int STREAM_num_dispatches = 0;
+    u32 STREAM_soft_time = 0;
+    u32 STREAM_hard_time = 0;
+    u32 STREAM_row_time[A_NUM_ROWS];        // When the last value of each datapoint was parsed
+    u32 STREAM_result_time[A_NUM_ROWS];     // When its result was available
+    int STREAM_result_memory[A_NUM_ROWS];   // Streamed results, HARD_result_memory only holds the final HARD run
+#endif
 
 // AXI-Stream
 u16 FIFODeviceId = FIFO_DEV_ID;
 XLlFifo FifoInstance; 	                    // AXIS-FIFO device instance
 XLlFifo* FifoInstancePtr = &FifoInstance; 
+u32 AXIS_tx_time = 0;                       // Cycles spent writing into the FIFO's TX, for the throughput per chunk size
+int AXIS_tx_words = 0;
+int AXIS_tx_chunks = 0;
+u32 AXIS_rx_max_delay = 0;                  // Worst cycles from the RC interrupt to the bottom half copying the packet out
+int AXIS_polling = 0;                       // FIFO-poll backend active, interrupts of the FIFO are off
 
 // AXI-DMA
 XAxiDma AxiDma;     // AXI_DMA driver instance
+int DMA_rx_unarmed = -1;                    // Batch sent by MM2S whose S2MM is not armed yet
 
 // Timer
 XTmrCtr TimerCounterInst;                   // AXI-Timer device instance
@@ -42,8 +147,8 @@ XTmrCtr* TimerCtrInstancePtr = &TimerCounterInst;
 
 // Interrupts
 static XScuGic IntC;                        // Interrupt Controller instance
-volatile int TX_done = 0;
-volatile int packets_received = 0;
+volatile int TX_done = 0;                   // TX complete, or room again in the FIFO's TX
+volatile int packets_received = 0;          // Packets copied out of the FIFO's RX since batch 0, packet k holds the results of batch k
 
 // SOFT
 u8 SOFT_hidden_layer_neurons[NUM_NEURONS_HIDDEN_LAYER][A_NUM_ROWS];
@@ -71,10 +176,57 @@ u8 sigmoid_LUT[256] = {12,12,12,12,13,13,13,14,14,14,15,15,15,16,16,16,
                         238,239,239,239,240,240,240,241,241,241,242,242,242,243,243,243};
 
 
+// Cascade (SOFT side), screen weights and band arrive after C
+#ifdef CASCADE_MODE
+    int* recv_s_matrix;
+    int* recv_band;
+    u8 SOFT_decided_stage[A_NUM_ROWS];
+    int SOFT_full_a_matrix[A_NUM_ROWS*A_NUM_COLS];     // Datapoints left for the full MLP, compacted
+    int SOFT_full_rows[A_NUM_ROWS];                     // Datapoint index of each compacted row
+    u8 SOFT_full_output[A_NUM_ROWS];
+    int SOFT_num_full_rows = 0;
+#endif
+
+
 // HARD
 int test_case_cnt = 0;
-int HARD_input_memory[NUMBER_OF_TEST_VECTORS*NUMBER_OF_INPUT_WORDS];
-int HARD_result_memory[NUMBER_OF_TEST_VECTORS*NUMBER_OF_OUTPUT_WORDS];
+int* HARD_result_memory;                   // From the DMA arena too
+int num_hard_batches = NUMBER_OF_TEST_VECTORS;
+
+// Result cache
+#ifdef RESULT_CACHE
+    result_cache ResultCache;
+    u32 model_id;
+    int num_misses;
+    u8 cached_results[NUMBER_OF_TEST_VECTORS*A_NUM_ROWS];          // Per datapoint of the workload, batch after batch
+    int cached_row_source[NUMBER_OF_TEST_VECTORS*A_NUM_ROWS];
+    u8 cached_soft_misses[NUMBER_OF_TEST_VECTORS*A_NUM_ROWS];      // SOFT results of the misses, in miss order
+    u8 cached_soft_output[A_NUM_ROWS];                             // SOFT through the cache, checked against the full SOFT run
+#endif
+
+// Backends
+const infer_backend* HARD_backend = NULL;   // Every batch of HARD_processing goes through it
+#ifdef RUNTIME_BACKENDS
+    u8 BACKEND_hidden_layer_neurons[NUM_NEURONS_HIDDEN_LAYER][A_NUM_ROWS];     // SOFT backend, apart from the reference of verify()
+    u8 BACKEND_output_layer_neurons[A_NUM_ROWS];
+    u8 BACKEND_decided_stage[A_NUM_ROWS];
+#endif
+
+// Model registry
+#ifdef MODEL_REGISTRY
+    model_registry ModelRegistry;
+    u32* DMA_opcode_word;                   // From the DMA arena, MM2S sends it ahead of the batch
+#endif
+
+// Heterogeneous split
+#ifdef HETERO_SPLIT
+    hetero_scheduler HeteroScheduler;
+    u8 HETERO_hidden_layer_neurons[NUM_NEURONS_HIDDEN_LAYER][A_NUM_ROWS];
+    u8 HETERO_output_layer_neurons[A_NUM_ROWS];
+    int HETERO_soft_batch = NUMBER_OF_TEST_VECTORS;   // Next SOFT rows: from row HETERO_soft_row of batch HETERO_soft_batch, none left yet
+    int HETERO_soft_row = 0;
+    u32 HETERO_soft_time = 0;                         // Cycles spent in SOFT for the current workload
+#endif
 
 /******************************* FUNCTION DECLARATIONS *************************************/
 int initialization();
@@ -83,7 +235,19 @@ int init_interrupts(XScuGic* IntC, XLlFifo* FifoInstancePtr, XTmrCtr* TimerCtrIn
 static void axi_stream_interrupt_handler (XLlFifo* FifoInstancePtr);
 static void timer_interrupt_handler();
 int AXIS_transmit(XLlFifo* FifoInstancePtr, int* HARD_input_memory);
-int AXIS_receive(XLlFifo* FifoInstancePtr);
+int AXIS_receive(XLlFifo* FifoInstancePtr, int batch);
+int AXIS_rx_bottom_half(XLlFifo* FifoInstancePtr);
+int HARD_processing(int num_batches);
+int HARD_idle();
+int backend_session();
+int count_mismatches();
+int hetero_processing();
+int hetero_soft_step();
+int bench_run_all();
+int stream_processing();
+void stream_print_latency();
 
-void SOFT_processing(char* recv_a_matrix, char* recv_b_matrix, char* recv_c_matrix, u8 (*SOFT_hidden_layer_neurons)[A_NUM_ROWS], u8* SOFT_output_layer_neurons);
+void SOFT_processing(int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix, u8 (*SOFT_hidden_layer_neurons)[A_NUM_ROWS], u8* SOFT_output_layer_neurons, int first_row, int end_row);
+void SOFT_cascade_processing(int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix, int* recv_s_matrix, int* recv_band,
+                             u8* SOFT_output_layer_neurons, u8* SOFT_decided_stage, int first_row, int end_row);
 u8 sigmoid_function(u8 sigmoid_LUT_index);
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "model_registry.h"
+#include "result_cache.h"
+#include "trace.h"
+
+static int weights_match(model_entry* entry, u32 model_id, int* weights) {
+    // Same hash is not enough, a collision would infer with the wrong weights
+    if (!entry->valid || entry->model_id != model_id) return 0;
+
+    for (int k = 0; k < NUMBER_OF_WEIGHT_WORDS; k++) {
+        if (entry->weights[k] != weights[k]) return 0;
+    }
+
+    return 1;
+}
+
+
+static int find_model(model_registry* registry, u32 model_id, int* weights) {
+    for (int handle = 0; handle < MODEL_REGISTRY_SIZE; handle++) {
+        if (weights_match(&registry->models[handle], model_id, weights)) return handle;
+    }
+
+    return MODEL_NONE;
+}
+
+
+static int allocate_model(model_registry* registry, u32 model_id, int* weights) {
+    int victim = 0;
+
+    // Prefer an empty slot, otherwise evict the least recently used model
+    for (int handle = 0; handle < MODEL_REGISTRY_SIZE; handle++) {
+        if (!registry->models[handle].valid) {
+            victim = handle;
+            break;
+        }
+        if (registry->models[handle].tick < registry->models[victim].tick) victim = handle;
+    }
+
+    model_entry* entry = &registry->models[victim];
+    if (entry->valid) registry->evictions++;
+    if (victim == registry->resident) registry->resident = MODEL_NONE;
+
+    entry->valid = 1;
+    entry->model_id = model_id;
+    for (int k = 0; k < NUMBER_OF_WEIGHT_WORDS; k++) {
+        entry->weights[k] = weights[k];
+    }
+    entry->uploads = 0;
+    entry->hits = 0;
+
+    return victim;
+}
+
+
+void model_registry_init(model_registry* registry) {
+    for (int handle = 0; handle < MODEL_REGISTRY_SIZE; handle++) {
+        registry->models[handle].valid = 0;
+    }
+
+    registry->resident = MODEL_NONE;
+    registry->tick = 0;
+    registry->uploads = 0;
+    registry->hits = 0;
+    registry->evictions = 0;
+}
+
+
+void model_registry_invalidate(model_registry* registry) {
+    // Coprocessor may have lost its weights, the next batch uploads them again
+    registry->resident = MODEL_NONE;
+}
+
+
+u32 model_registry_opcode_word(model_registry* registry, int* batch) {
+    // Opcode word leading 'batch' of the ingest buffer, the registry takes its weights as resident from now on
+    int* weights = batch + B_OFFSET;
+    u32 model_id = result_cache_model_id(batch + B_OFFSET, batch + C_OFFSET);
+
+    int handle = find_model(registry, model_id, weights);
+    if (handle == MODEL_NONE) handle = allocate_model(registry, model_id, weights);
+
+    model_entry* entry = &registry->models[handle];
+    entry->tick = ++registry->tick;
+
+    if (handle == registry->resident) {
+        entry->hits++;
+        registry->hits++;
+        return MODEL_OPCODE_WORD(handle, OPCODE_INFER_RESIDENT);
+    }
+
+    entry->uploads++;
+    registry->uploads++;
+    registry->resident = handle;
+    TRACE_INFO(TRACE_MODEL_UPLOAD, handle, model_id, 0);
+    return MODEL_OPCODE_WORD(handle, OPCODE_INFER);
+}
+
+
+int model_registry_num_words(u32 opcode_word) {
+    // Words of the batch following the opcode word, B and C are left out when they are resident
+    if ((opcode_word & OPCODE_MASK) == OPCODE_INFER_RESIDENT) return A_NUM_ROWS*A_NUM_COLS;
+    return NUMBER_OF_INPUT_WORDS;
+}
+
+
+void model_registry_print_stats(model_registry* registry) {
+    xil_printf("Model registry: %d uploads, %d hits, %d evictions, %d weight words not sent\n",
+               registry->uploads, registry->hits, registry->evictions, registry->hits*NUMBER_OF_WEIGHT_WORDS);
+    for (int handle = 0; handle < MODEL_REGISTRY_SIZE; handle++) {
+        model_entry* entry = &registry->models[handle];
+        if (!entry->valid) continue;
+        xil_printf(" Model %d (%08x): %d uploads, %d hits%s\n", handle, entry->model_id, entry->uploads, entry->hits,
+                   (handle == registry->resident) ? ", resident" : "");
+    }
+}
\ No newline at end of file
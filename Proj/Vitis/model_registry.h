@@ -0,0 +1,44 @@
+#ifndef COMMON_HEADER
+    #define COMMON_HEADER
+    #include "common.h"
+#endif
+
+// Weights (B, C) resident in the coprocessor, so a batch only carries them when they change
+// Every batch is looked up by the hash of its weights (same model id as the result cache), then confirmed word by word
+//  - Weights already resident: opcode word OPCODE_INFER_RESIDENT, then A only
+//  - Otherwise:                opcode word OPCODE_INFER, then A, B, C, which become the resident weights
+// The opcode word also carries the handle (registry slot) of the model the batch runs with
+// Needs the coprocessor built with ONLINE_TRAINING (Proj/HLS), batch by batch backends only (FIFO, polling DMA)
+//#define MODEL_REGISTRY
+#define MODEL_REGISTRY_SIZE     8       // Models remembered, the least recently used one makes room
+#define MODEL_NONE              -1      // Nothing resident, e.g after the transport was (re)initialized
+
+#define MODEL_OPCODE_WORD(handle, opcode)   (((u32)(handle) << OPCODE_MODEL_SHIFT) | (opcode))
+
+typedef struct {
+    int valid;
+    u32 model_id;
+    int weights[NUMBER_OF_WEIGHT_WORDS];   // B then C, as they lie in a batch
+    u32 tick;                               // For LRU replacement
+
+    // Instrumentation
+    u32 uploads;
+    u32 hits;
+} model_entry;
+
+typedef struct {
+    model_entry models[MODEL_REGISTRY_SIZE];
+    int resident;                           // Handle of the weights the coprocessor holds, or MODEL_NONE
+    u32 tick;
+
+    // Instrumentation
+    u32 uploads;
+    u32 hits;
+    u32 evictions;
+} model_registry;
+
+void model_registry_init(model_registry* registry);
+void model_registry_invalidate(model_registry* registry);
+u32 model_registry_opcode_word(model_registry* registry, int* batch);
+int model_registry_num_words(u32 opcode_word);
+void model_registry_print_stats(model_registry* registry);
\ No newline at end of file
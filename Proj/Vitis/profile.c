@@ -0,0 +1,90 @@
+#include "profile.h"
+
+static XTmrCtr* profile_timer = NULL;
+static profile_span profile_spans[PROFILE_NUM_PHASES];
+static const char* const profile_names[PROFILE_NUM_PHASES] = {
+    "UART ingest", "Pack", "SOFT", "TX", "Compute wait", "RX", "Result TX", "Verify"
+};
+
+static u32 cycles_to_ns(u64 cycles) {
+    // Spans stay far below the 4s a u32 of ns can hold, except verify() printing every result
+    u64 ns = (cycles * 1000000000ULL) / PROFILE_TIMER_FREQ;
+    return (ns > 0xFFFFFFFFULL) ? 0xFFFFFFFF : (u32)ns;
+}
+
+static void print_us(u64 cycles) {
+    u32 ns = cycles_to_ns(cycles);
+    xil_printf(" %8d.%03d", ns / 1000, ns % 1000);
+}
+
+static void sort_samples(u64* samples, int num_samples) {
+    // Insertion sort, at most PROFILE_MAX_SAMPLES and only once, after the run
+    for (int i = 1; i < num_samples; i++) {
+        u64 sample = samples[i];
+        int j = i - 1;
+
+        while (j >= 0 && samples[j] > sample) {
+            samples[j + 1] = samples[j];
+            j--;
+        }
+        samples[j + 1] = sample;
+    }
+}
+
+int profile_init(XTmrCtr* TimerCtrInstancePtr) {
+    profile_timer = TimerCtrInstancePtr;
+
+    for (int phase = 0; phase < PROFILE_NUM_PHASES; phase++) {
+        profile_spans[phase].start = 0;
+        profile_spans[phase].num_samples = 0;
+        profile_spans[phase].total = 0;
+        profile_spans[phase].min = ~(u64)0;
+        profile_spans[phase].max = 0;
+    }
+
+    return init_timer_cascade(TimerCtrInstancePtr);
+}
+
+void profile_begin(profile_phase phase) {
+    // Counter starts at 0, a span opened right away still reads as open
+    u64 now = timer_get_value64(profile_timer);
+    profile_spans[phase].start = (now != 0) ? now : 1;
+}
+
+void profile_end(profile_phase phase) {
+    // Closing a span which is not open does nothing, so an end may sit where it runs more than once per begin
+    profile_span* span = &profile_spans[phase];
+    if (span->start == 0) return;
+
+    u64 cycles = timer_get_value64(profile_timer) - span->start;
+    span->start = 0;
+
+    if (span->num_samples < PROFILE_MAX_SAMPLES) span->samples[span->num_samples] = cycles;
+    span->num_samples++;
+    span->total += cycles;
+    if (cycles < span->min) span->min = cycles;
+    if (cycles > span->max) span->max = cycles;
+}
+
+void profile_print() {
+    xil_printf("\nPhase               n     min (us)    mean (us)     p50 (us)     p99 (us)     max (us)");
+
+    for (int phase = 0; phase < PROFILE_NUM_PHASES; phase++) {
+        profile_span* span = &profile_spans[phase];
+        if (span->num_samples == 0) continue;
+
+        // Nearest rank percentiles
+        int num_sorted = (span->num_samples < PROFILE_MAX_SAMPLES) ? span->num_samples : PROFILE_MAX_SAMPLES;
+        sort_samples(span->samples, num_sorted);
+        u64 p50 = span->samples[(num_sorted*50 + 99)/100 - 1];
+        u64 p99 = span->samples[(num_sorted*99 + 99)/100 - 1];
+
+        xil_printf("\n%-14s %6d", profile_names[phase], span->num_samples);
+        print_us(span->min);
+        print_us(span->total / span->num_samples);
+        print_us(p50);
+        print_us(p99);
+        print_us(span->max);
+    }
+    xil_printf("\n");
+}
\ No newline at end of file
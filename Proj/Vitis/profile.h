@@ -0,0 +1,57 @@
+#ifndef COMMON_HEADER
+    #define COMMON_HEADER
+    #include "common.h"
+#endif
+
+#include "timer.h"
+
+// Per-phase profiling on the 64-bit (cascaded) AXI-Timer
+// Each phase is a named span, timed once per batch (or per call where the transport hides the batches, DMA interrupt/SG modes)
+// Replaces the "SW mult" / "HW mult" lines with min/mean/p50/p99 per phase
+//  - UART ingest:   files received from Realterm
+//  - Pack:          ingest buffer made ready for the coprocessor (result cache compaction, batch copies), the UART parser already writes its layout
+//  - SOFT:          SOFT computation of the whole batch
+//  - TX:            input handed to the coprocessor, until the FIFO/MM2S has taken all of it
+//  - Compute wait:  from the end of TX until results can be read
+//  - RX:            results copied out of the FIFO (DMA: the S2MM wait and invalidate are one span with compute wait)
+//  - Result TX:     results queued to the UART
+//  - Verify:        verify()
+//#define PROFILE
+
+#define PROFILE_MAX_SAMPLES     256     // Percentiles are over the first samples of each phase, min/mean keep counting all of them
+#define PROFILE_TIMER_FREQ      XPAR_TMRCTR_0_CLOCK_FREQ_HZ
+
+typedef enum {
+    PROFILE_UART_INGEST = 0,
+    PROFILE_PACK,
+    PROFILE_SOFT,
+    PROFILE_TX,
+    PROFILE_COMPUTE_WAIT,
+    PROFILE_RX,
+    PROFILE_RESULT_TX,
+    PROFILE_VERIFY,
+    PROFILE_NUM_PHASES
+} profile_phase;
+
+typedef struct {
+    u64 start;              // 0 while the span is not open
+    u32 num_samples;
+    u64 total;
+    u64 min;
+    u64 max;
+    u64 samples[PROFILE_MAX_SAMPLES];
+} profile_span;
+
+// Spans vanish from the build without PROFILE
+#ifdef PROFILE
+    #define PROFILE_BEGIN(phase)    profile_begin(phase)
+    #define PROFILE_END(phase)      profile_end(phase)
+#else
+    #define PROFILE_BEGIN(phase)
+    #define PROFILE_END(phase)
+#endif
+
+int profile_init(XTmrCtr* TimerCtrInstancePtr);
+void profile_begin(profile_phase phase);
+void profile_end(profile_phase phase);
+void profile_print();
\ No newline at end of file
@@ -0,0 +1,197 @@
+#include "result_cache.h"
+
+static u32 hash_row(u32 model_id, int* row) {
+    // FNV-1a over the 7 features of the datapoint, seeded with the model id
+    u32 hash = FNV_OFFSET_BASIS ^ model_id;
+
+    for (int j = 0; j < A_NUM_COLS; j++) {
+        hash ^= (u8)row[j];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+
+static int row_matches(result_cache_entry* entry, u32 model_id, int* row) {
+    if (entry->state == RESULT_CACHE_EMPTY || entry->model_id != model_id) return 0;
+
+    for (int j = 0; j < A_NUM_COLS; j++) {
+        if (entry->row[j] != (u8)row[j]) return 0;
+    }
+
+    return 1;
+}
+
+
+static result_cache_entry* find_entry(result_cache* cache, u32 model_id, int* row) {
+    result_cache_entry* set = cache->sets[hash_row(model_id, row) & (RESULT_CACHE_NUM_SETS-1)];
+
+    for (int way = 0; way < RESULT_CACHE_NUM_WAYS; way++) {
+        if (row_matches(&set[way], model_id, row)) return &set[way];
+    }
+
+    return NULL;
+}
+
+
+static result_cache_entry* allocate_entry(result_cache* cache, u32 model_id, int* row) {
+    result_cache_entry* set = cache->sets[hash_row(model_id, row) & (RESULT_CACHE_NUM_SETS-1)];
+    result_cache_entry* victim = &set[0];
+
+    // Prefer an empty way, otherwise evict the least recently used one
+    for (int way = 0; way < RESULT_CACHE_NUM_WAYS; way++) {
+        if (set[way].state == RESULT_CACHE_EMPTY) {
+            victim = &set[way];
+            break;
+        }
+        if (set[way].tick < victim->tick) victim = &set[way];
+    }
+
+    if (victim->state != RESULT_CACHE_EMPTY) cache->evictions++;
+
+    victim->model_id = model_id;
+    for (int j = 0; j < A_NUM_COLS; j++) {
+        victim->row[j] = row[j];
+    }
+
+    return victim;
+}
+
+
+void result_cache_init(result_cache* cache) {
+    for (int set = 0; set < RESULT_CACHE_NUM_SETS; set++) {
+        for (int way = 0; way < RESULT_CACHE_NUM_WAYS; way++) {
+            cache->sets[set][way].state = RESULT_CACHE_EMPTY;
+            cache->sets[set][way].tick = 0;
+        }
+    }
+
+    cache->tick = 0;
+    cache->hits = 0;
+    cache->dedups = 0;
+    cache->misses = 0;
+    cache->evictions = 0;
+}
+
+
+u32 result_cache_model_id(int* recv_b_matrix, int* recv_c_matrix) {
+    // Any change in the weights gives a different model id, so stale results are never returned
+    u32 hash = FNV_OFFSET_BASIS;
+
+    for (int i = 0; i < B_NUM_ROWS*B_NUM_COLS; i++) {
+        hash ^= (u8)recv_b_matrix[i];
+        hash *= FNV_PRIME;
+    }
+    for (int i = 0; i < C_NUM_ROWS*C_NUM_COLS; i++) {
+        hash ^= (u8)recv_c_matrix[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+
+static int* workload_row(int* inputs, int row) {
+    // Rows of the workload are numbered across batches, row 'row' lives in batch row/A_NUM_ROWS of the ingest buffer
+    return &inputs[(row/A_NUM_ROWS)*NUMBER_OF_INPUT_WORDS + A_OFFSET + (row%A_NUM_ROWS)*A_NUM_COLS];
+}
+
+
+int result_cache_partition(result_cache* cache, u32 model_id, int* inputs, int num_batches,
+                           u8* cached_results, int* row_source) {
+    // Splits the datapoints of all 'num_batches' batches of the ingest buffer into
+    //  - Hits, whose result is written into cached_results[i] (row_source[i] == RESULT_CACHE_MISS_NONE)
+    //  - Misses, which are compacted in place into the A matrices of the first batches (row_source[i] == index of the compacted row)
+    // Compacting in place is safe, a miss is always moved to a row at or before its own, which has already been looked up
+    // Repeated rows, within a batch or across batches, are only computed once, they find the PENDING entry of the first occurrence (dedups)
+    // B, C of the batches are left alone, all batches of a workload carry the same weights
+    int num_misses = 0;
+
+    for (int i = 0; i < num_batches*A_NUM_ROWS; i++) {
+        int* row = workload_row(inputs, i);
+        result_cache_entry* entry = find_entry(cache, model_id, row);
+
+        if (entry != NULL) {
+            entry->tick = ++cache->tick;
+
+            if (entry->state == RESULT_CACHE_VALID) {
+                cache->hits++;
+                cached_results[i] = entry->result;
+                row_source[i] = RESULT_CACHE_MISS_NONE;
+            } else {
+                cache->dedups++;
+                row_source[i] = entry->result;
+            }
+        }
+        else {
+            cache->misses++;
+            entry = allocate_entry(cache, model_id, row);
+            entry->state = RESULT_CACHE_PENDING;
+            entry->result = num_misses;
+            entry->tick = ++cache->tick;
+
+            int* miss_row = workload_row(inputs, num_misses);
+            for (int j = 0; j < A_NUM_COLS; j++) {
+                miss_row[j] = row[j];
+            }
+            row_source[i] = num_misses;
+            num_misses++;
+        }
+    }
+
+    // Pad the rest of the last batch with misses, SOFT and HARD always operate on a full A matrix
+    for (int k = num_misses; k < result_cache_num_batches(num_misses)*A_NUM_ROWS; k++) {
+        int* pad_row = workload_row(inputs, k);
+        for (int j = 0; j < A_NUM_COLS; j++) {
+            pad_row[j] = 0;
+        }
+    }
+
+    return num_misses;
+}
+
+
+int result_cache_num_batches(int num_misses) {
+    // Number of batches the HARD path actually needs to run
+    return (num_misses + A_NUM_ROWS - 1) / A_NUM_ROWS;
+}
+
+
+void result_cache_fill(result_cache* cache, u32 model_id, int* inputs, int num_misses, int* miss_results) {
+    // Miss k is row k of the compacted workload, its result is word k of the results (one word per row, batch after batch)
+    for (int k = 0; k < num_misses; k++) {
+        result_cache_entry* entry = find_entry(cache, model_id, workload_row(inputs, k));
+
+        // PENDING entry may have been evicted by a later miss, the result is then simply not kept
+        // Allocating a line again here would evict yet another one, possibly PENDING as well
+        if (entry == NULL) continue;
+
+        entry->state = RESULT_CACHE_VALID;
+        entry->result = miss_results[k];
+        entry->tick = ++cache->tick;
+    }
+}
+
+
+void result_cache_expand_soft(u8* cached_results, int* row_source, int num_rows, u8* miss_results, u8* SOFT_output_layer_neurons) {
+    // SOFT computed the misses (miss_results, in miss order), put the results of the first 'num_rows' datapoints back into datapoint order
+    for (int i = 0; i < num_rows; i++) {
+        SOFT_output_layer_neurons[i] = (row_source[i] == RESULT_CACHE_MISS_NONE) ? cached_results[i] : miss_results[row_source[i]];
+    }
+}
+
+
+void result_cache_expand_hard(u8* cached_results, int* row_source, int num_rows, int* HARD_result_memory) {
+    // HARD_result_memory is in miss order, put it back into datapoint order, in place
+    // Row i only ever takes the result of miss row_source[i] <= i, going backwards it is never overwritten before it is read
+    for (int i = num_rows-1; i >= 0; i--) {
+        HARD_result_memory[i] = (row_source[i] == RESULT_CACHE_MISS_NONE) ? cached_results[i] : HARD_result_memory[row_source[i]];
+    }
+}
+
+
+void result_cache_print_stats(result_cache* cache) {
+    xil_printf("Result cache: %d hits, %d repeats within the workload, %d misses, %d evictions\n",
+               cache->hits, cache->dedups, cache->misses, cache->evictions);
+}
\ No newline at end of file
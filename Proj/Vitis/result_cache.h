@@ -0,0 +1,50 @@
+#ifndef COMMON_HEADER
+    #define COMMON_HEADER
+    #include "common.h"
+#endif
+
+// Small hash-indexed cache of inference results, sitting in front of SOFT_processing and the HARD path.
+// Key is the 7-feature datapoint (row of A matrix, one word per feature) together with the id of the model (B,C weights) that produced the result.
+// Cache is set-associative, RESULT_CACHE_NUM_SETS must be a power of 2.
+#define RESULT_CACHE_NUM_SETS   128
+#define RESULT_CACHE_NUM_WAYS   4
+#define RESULT_CACHE_MISS_NONE  -1  // row_source entry for rows which are served from the cache
+
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME        16777619u
+
+typedef enum {
+    RESULT_CACHE_EMPTY = 0,
+    RESULT_CACHE_PENDING,   // Row has missed in the current workload, result not computed yet. 'result' holds the miss slot instead
+    RESULT_CACHE_VALID
+} result_cache_state;
+
+typedef struct {
+    u8 state;
+    u8 row[A_NUM_COLS];
+    u32 model_id;
+    u32 tick;           // For LRU replacement within a set
+    u32 result;
+} result_cache_entry;
+
+typedef struct {
+    result_cache_entry sets[RESULT_CACHE_NUM_SETS][RESULT_CACHE_NUM_WAYS];
+    u32 tick;
+
+    // Instrumentation
+    u32 hits;           // Served from a result computed by an earlier workload
+    u32 dedups;         // Repeated within the workload, computed once with its first occurrence
+    u32 misses;
+    u32 evictions;
+} result_cache;
+
+void result_cache_init(result_cache* cache);
+u32 result_cache_model_id(int* recv_b_matrix, int* recv_c_matrix);
+
+int result_cache_partition(result_cache* cache, u32 model_id, int* inputs, int num_batches,
+                           u8* cached_results, int* row_source);
+int result_cache_num_batches(int num_misses);
+void result_cache_fill(result_cache* cache, u32 model_id, int* inputs, int num_misses, int* miss_results);
+void result_cache_expand_soft(u8* cached_results, int* row_source, int num_rows, u8* miss_results, u8* SOFT_output_layer_neurons);
+void result_cache_expand_hard(u8* cached_results, int* row_source, int num_rows, int* HARD_result_memory);
+void result_cache_print_stats(result_cache* cache);
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include "soft_parallel.h"
+#include "soft_simd.h"
+
+// Mailbox of core k is soft_mailboxes[k], core 0 only keeps its own slice and timing in soft_mailboxes[0]
+static soft_mailbox* const soft_mailboxes = (soft_mailbox*)SOFT_PARALLEL_MAILBOX_BASEADDR;
+static int soft_num_cores = 1;      // Core 0, plus the workers which answered soft_parallel_init
+
+static void run_slice(soft_mailbox* job) {
+    // Every core runs the fastest single core SOFT of its build on its slice
+    XTime start_time, end_time;
+    XTime_GetTime(&start_time);
+
+    for (int repeat = 0; repeat < job->repeats; repeat++) {
+        #ifdef SOFT_SIMD
+            SOFT_processing_simd(job->recv_a_matrix, job->recv_b_matrix, job->recv_c_matrix, job->SOFT_hidden_layer_neurons, job->SOFT_output_layer_neurons,
+                                 job->first_row, job->end_row);
+        #else
+            SOFT_processing(job->recv_a_matrix, job->recv_b_matrix, job->recv_c_matrix, job->SOFT_hidden_layer_neurons, job->SOFT_output_layer_neurons,
+                            job->first_row, job->end_row);
+        #endif
+    }
+
+    XTime_GetTime(&end_time);
+    job->total_rows += (job->end_row - job->first_row)*job->repeats;
+    job->total_time += end_time - start_time;
+}
+
+static void reset_timing() {
+    for (int core = 0; core < soft_num_cores; core++) {
+        soft_mailboxes[core].total_rows = 0;
+        soft_mailboxes[core].total_time = 0;
+    }
+}
+
+static void soft_parallel_run(int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix, u8 (*SOFT_hidden_layer_neurons)[A_NUM_ROWS],
+                              u8* SOFT_output_layer_neurons, int first_row, int end_row, int num_cores, int repeats) {
+    // Slices are whole SIMD blocks, only the last one may be shorter
+    int slice_rows = (end_row - first_row + num_cores - 1) / num_cores;
+    slice_rows = ((slice_rows + SOFT_SIMD_BLOCK_ROWS - 1) / SOFT_SIMD_BLOCK_ROWS) * SOFT_SIMD_BLOCK_ROWS;
+
+    int num_jobs = 0;
+    for (int core = 0; core < num_cores; core++) {
+        int slice_first_row = first_row + core*slice_rows;
+        if (slice_first_row >= end_row) break;
+
+        soft_mailbox* job = &soft_mailboxes[core];
+        job->recv_a_matrix = recv_a_matrix;
+        job->recv_b_matrix = recv_b_matrix;
+        job->recv_c_matrix = recv_c_matrix;
+        job->SOFT_hidden_layer_neurons = SOFT_hidden_layer_neurons;
+        job->SOFT_output_layer_neurons = SOFT_output_layer_neurons;
+        job->first_row = slice_first_row;
+        job->end_row = (slice_first_row + slice_rows < end_row) ? slice_first_row + slice_rows : end_row;
+        job->repeats = repeats;
+        num_jobs++;
+    }
+
+    // Job fields must be visible before the new sequence, then wake the workers up
+    dmb();
+    for (int core = 1; core < num_jobs; core++) {
+        soft_mailboxes[core].sequence++;
+    }
+    dsb();
+    sev();
+
+    run_slice(&soft_mailboxes[0]);
+
+    // Barrier: every slice is done once each worker has caught up with its sequence
+    for (int core = 1; core < num_jobs; core++) {
+        while (soft_mailboxes[core].done != soft_mailboxes[core].sequence) {
+            wfe();
+        }
+    }
+    // Results of the workers are read after their 'done'
+    dmb();
+}
+
+int soft_parallel_init() {
+    // Workers were started by the boot image (host: host_cores.c), use those which are waiting for jobs
+    // A worker which does not show up leaves out the cores after it, SOFT still runs on the ones before
+    // Polled, not WFE: a core which was never started never SEVs, and nothing else would wake core 0 up
+    XTime start_time, now;
+    XTime_GetTime(&start_time);
+
+    soft_num_cores = 1;
+    for (int core = 1; core < SOFT_NUM_CORES; core++) {
+        while (soft_mailboxes[core].ready != SOFT_PARALLEL_READY) {
+            XTime_GetTime(&now);
+            if (now - start_time > ((XTime)SOFT_PARALLEL_READY_TIMEOUT_US * COUNTS_PER_SECOND) / 1000000) break;
+        }
+        if (soft_mailboxes[core].ready != SOFT_PARALLEL_READY) break;
+
+        soft_num_cores++;
+    }
+
+    if (soft_num_cores != SOFT_NUM_CORES) {
+        xil_printf("SOFT_PARALLEL: only %d of %d cores answered\n", soft_num_cores, SOFT_NUM_CORES);
+    }
+
+    reset_timing();
+    return XST_SUCCESS;
+}
+
+void soft_parallel_worker(int core) {
+    // Main loop of cores 1..3, never returns
+    soft_mailbox* mailbox = &soft_mailboxes[core];
+    u32 sequence = mailbox->sequence;
+
+    mailbox->done = sequence;
+    mailbox->total_rows = 0;
+    mailbox->total_time = 0;
+    dmb();
+    mailbox->ready = SOFT_PARALLEL_READY;
+    dsb();
+    sev();
+
+    while (1) {
+        while (mailbox->sequence == sequence) {
+            wfe();
+        }
+        // Job fields are read after the new sequence
+        dmb();
+        sequence = mailbox->sequence;
+
+        run_slice(mailbox);
+
+        // Results must be visible before 'done'
+        dmb();
+        mailbox->done = sequence;
+        dsb();
+        sev();
+    }
+}
+
+void SOFT_processing_parallel(int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix,
+                              u8 (*SOFT_hidden_layer_neurons)[A_NUM_ROWS], u8* SOFT_output_layer_neurons, int first_row, int end_row) {
+    int num_cores = (end_row - first_row < SOFT_PARALLEL_MIN_ROWS) ? 1 : soft_num_cores;
+
+    soft_parallel_run(recv_a_matrix, recv_b_matrix, recv_c_matrix, SOFT_hidden_layer_neurons, SOFT_output_layer_neurons,
+                      first_row, end_row, num_cores, 1);
+}
+
+static void print_core_timing(int num_cores) {
+    // Down to the ns, a slice of the normal run is too short for whole microseconds
+    for (int core = 0; core < num_cores; core++) {
+        u64 time = soft_mailboxes[core].total_time;
+        u64 time_us = (time * 1000000) / COUNTS_PER_SECOND;
+        u32 time_ns = (u32)((((time * 1000000) % COUNTS_PER_SECOND) * 1000) / COUNTS_PER_SECOND);
+        u32 rows_per_second = (time == 0) ? 0 : (u32)(((u64)soft_mailboxes[core].total_rows * COUNTS_PER_SECOND) / time);
+        xil_printf("\nSOFT core %d: %d rows in %d.%03d us, %d rows/s", core, soft_mailboxes[core].total_rows, (u32)time_us, time_ns, rows_per_second);
+    }
+}
+
+void soft_parallel_print_timing() {
+    print_core_timing(soft_num_cores);
+}
+
+int soft_parallel_benchmark(int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix) {
+    // Same work on 1..soft_num_cores cores, each run must match the scalar SOFT_processing bit for bit
+    static u8 reference_hidden[NUM_NEURONS_HIDDEN_LAYER][A_NUM_ROWS];
+    static u8 reference_output[A_NUM_ROWS];
+    static u8 hidden[NUM_NEURONS_HIDDEN_LAYER][A_NUM_ROWS];
+    static u8 output[A_NUM_ROWS];
+    u32 one_core_us = 0;
+
+    SOFT_processing(recv_a_matrix, recv_b_matrix, recv_c_matrix, reference_hidden, reference_output, 0, A_NUM_ROWS);
+
+    for (int num_cores = 1; num_cores <= soft_num_cores; num_cores++) {
+        XTime start_time, end_time;
+        reset_timing();
+        XTime_GetTime(&start_time);
+        soft_parallel_run(recv_a_matrix, recv_b_matrix, recv_c_matrix, hidden, output, 0, A_NUM_ROWS, num_cores, SOFT_PARALLEL_BENCHMARK_REPEATS);
+        XTime_GetTime(&end_time);
+
+        for (int i = 0; i < A_NUM_ROWS; i++) {
+            if (output[i] != reference_output[i] || hidden[HIDDEN_LAYER_FIRST_NEURON][i] != reference_hidden[HIDDEN_LAYER_FIRST_NEURON][i]
+                                                 || hidden[HIDDEN_LAYER_SECOND_NEURON][i] != reference_hidden[HIDDEN_LAYER_SECOND_NEURON][i]) {
+                xil_printf("SOFT on %d cores differs from scalar at datapoint %d\n", num_cores, i);
+                return XST_FAILURE;
+            }
+        }
+
+        u32 num_rows = A_NUM_ROWS*SOFT_PARALLEL_BENCHMARK_REPEATS;
+        u32 time_us = (u32)(((end_time - start_time) * 1000000) / COUNTS_PER_SECOND);
+        if (time_us == 0) time_us = 1;
+        if (num_cores == 1) one_core_us = time_us;
+        u32 speedup = (one_core_us * 100) / time_us;
+
+        xil_printf("SOFT on %d cores: %d rows in %d us, %d rows/s, %d.%02dx", num_cores, num_rows, time_us,
+                   (u32)(((u64)num_rows * 1000000) / time_us), speedup / 100, speedup % 100);
+
+        // Per core, summed over the SOFT_PARALLEL_BENCHMARK_REPEATS runs of its slice
+        print_core_timing(num_cores);
+        xil_printf("\n");
+    }
+
+    reset_timing();
+    return XST_SUCCESS;
+}
\ No newline at end of file
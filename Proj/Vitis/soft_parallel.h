@@ -0,0 +1,52 @@
+#ifndef COMMON_HEADER
+    #define COMMON_HEADER
+    #include "common.h"
+#endif
+
+#include "xtime_l.h"
+#include "xpseudo_asm.h"
+
+// SOFT spread over the 4 A53 cores (AMP): core 0 runs this application, cores 1..3 each run a worker
+// Rows are split into one contiguous slice per core, each core computes its slice, core 0 waits for all of them (barrier)
+// Workers
+//  - Board: this same application built with -DSOFT_PARALLEL_WORKER_CORE=<1..3>, linked into the core's own DDR region,
+//    all four ELFs in the boot image (each with its destination_cpu), main() of a worker never returns
+//  - Host: one thread per worker core (host/host_cores.c), woken the same way
+// Core 0 and the workers only share the mailboxes (in OCM) and the buffers they point to, A53 caches are coherent within the cluster
+//#define SOFT_PARALLEL
+//#define SOFT_PARALLEL_BENCHMARK     // Rows per second on 1..SOFT_NUM_CORES cores, before the normal run
+
+#define SOFT_NUM_CORES                  XPAR_CPU_CORES_NUM
+#define SOFT_PARALLEL_MIN_ROWS          16      // Fewer rows than this are not worth waking the other cores for
+#define SOFT_PARALLEL_READY             0x50F7C0DE
+#define SOFT_PARALLEL_READY_TIMEOUT_US  100000  // soft_parallel_init gives up on a worker which is not waiting for jobs by then
+#define SOFT_PARALLEL_BENCHMARK_REPEATS 2000
+#define SOFT_PARALLEL_MAILBOX_BASEADDR  XPAR_PSU_OCM_RAM_0_S_AXI_BASEADDR   // Keep every application of the boot image out of the first 4KB of OCM
+
+// One per worker core, written by core 0 (job) then by the worker (completion)
+// A job is posted by incrementing 'sequence', it is complete once 'done' has caught up
+typedef struct {
+    volatile u32 ready;             // SOFT_PARALLEL_READY once the worker is waiting for jobs
+    volatile u32 sequence;
+    volatile u32 done;
+
+    int* recv_a_matrix;
+    int* recv_b_matrix;
+    int* recv_c_matrix;
+    u8 (*SOFT_hidden_layer_neurons)[A_NUM_ROWS];
+    u8* SOFT_output_layer_neurons;
+    int first_row;
+    int end_row;
+    int repeats;                    // Runs of the slice per job, > 1 only for SOFT_PARALLEL_BENCHMARK
+
+    // Per core timing, summed over the jobs
+    volatile u32 total_rows;
+    volatile XTime total_time;
+} soft_mailbox;
+
+int soft_parallel_init();
+void soft_parallel_worker(int core);
+void SOFT_processing_parallel(int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix,
+                              u8 (*SOFT_hidden_layer_neurons)[A_NUM_ROWS], u8* SOFT_output_layer_neurons, int first_row, int end_row);
+void soft_parallel_print_timing();
+int soft_parallel_benchmark(int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix);
\ No newline at end of file
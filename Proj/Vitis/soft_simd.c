@@ -0,0 +1,234 @@
+#include "soft_simd.h"
+#include "timer.h"
+#include <string.h>
+
+/*********************************** NEON *********************************************/
+#ifdef SOFT_SIMD_NEON
+// Byte index (into 8 datapoints narrowed to 56 bytes) of each feature, two datapoints per vector
+// Feature 7 does not exist, out of range index 0xFF reads as 0 and leaves the sums alone
+static const u8 neon_pack_index[SOFT_SIMD_BLOCK_ROWS/2][16] = {
+    { 0,  1,  2,  3,  4,  5,  6, 0xFF,  7,  8,  9, 10, 11, 12, 13, 0xFF},
+    {14, 15, 16, 17, 18, 19, 20, 0xFF, 21, 22, 23, 24, 25, 26, 27, 0xFF},
+    {28, 29, 30, 31, 32, 33, 34, 0xFF, 35, 36, 37, 38, 39, 40, 41, 0xFF},
+    {42, 43, 44, 45, 46, 47, 48, 0xFF, 49, 50, 51, 52, 53, 54, 55, 0xFF}
+};
+
+static inline void neon_load_rows(int* rows, uint8x16_t packed[SOFT_SIMD_BLOCK_ROWS/2]) {
+    // 8 datapoints (56 words) narrowed to bytes, truncated like the (u8) of the scalar code, then spread to 8 bytes per datapoint
+    uint8x8_t narrowed[8];
+    uint8x16x4_t bytes;
+
+    for (int k = 0; k < A_NUM_COLS; k++) {
+        uint16x8_t halves = vcombine_u16(vmovn_u32(vld1q_u32((u32*)&rows[8*k])), vmovn_u32(vld1q_u32((u32*)&rows[8*k + 4])));
+        narrowed[k] = vmovn_u16(halves);
+    }
+    narrowed[7] = vdup_n_u8(0);
+
+    for (int k = 0; k < 4; k++) {
+        bytes.val[k] = vcombine_u8(narrowed[2*k], narrowed[2*k + 1]);
+    }
+    for (int k = 0; k < SOFT_SIMD_BLOCK_ROWS/2; k++) {
+        packed[k] = vqtbl4q_u8(bytes, vld1q_u8(neon_pack_index[k]));
+    }
+}
+
+static inline uint32x4_t neon_dot_rows(uint8x16_t rows_01, uint8x16_t rows_23, uint8x16_t weights) {
+    // Sums of 4 datapoints: u8 x u8 -> u16 products, then pairwise added into u32 until one sum per datapoint is left
+    uint32x4_t sum_0 = vpaddlq_u16(vmull_u8(vget_low_u8(rows_01), vget_low_u8(weights)));
+    uint32x4_t sum_1 = vpaddlq_u16(vmull_high_u8(rows_01, weights));
+    uint32x4_t sum_2 = vpaddlq_u16(vmull_u8(vget_low_u8(rows_23), vget_low_u8(weights)));
+    uint32x4_t sum_3 = vpaddlq_u16(vmull_high_u8(rows_23, weights));
+
+    return vpaddq_u32(vpaddq_u32(sum_0, sum_1), vpaddq_u32(sum_2, sum_3));
+}
+
+static inline uint8x8_t neon_neuron(uint32x4_t sum_lo, uint32x4_t sum_hi, u32 bias) {
+    // Include the bias term, restore precision, keep the low 8 bits (as storing into u8 does)
+    sum_lo = vshrq_n_u32(vaddq_u32(sum_lo, vdupq_n_u32(bias)), NUM_FRACTIONAL_BITS);
+    sum_hi = vshrq_n_u32(vaddq_u32(sum_hi, vdupq_n_u32(bias)), NUM_FRACTIONAL_BITS);
+
+    return vmovn_u16(vcombine_u16(vmovn_u32(sum_lo), vmovn_u32(sum_hi)));
+}
+
+void SOFT_processing_neon(int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix,
+                          u8 (*SOFT_hidden_layer_neurons)[A_NUM_ROWS], u8* SOFT_output_layer_neurons, int first_row, int end_row) {
+    // Weights as u8 (they are 0..255), 7 weights and a 0, twice (one copy per datapoint of a vector)
+    u8 weights[NUM_NEURONS_HIDDEN_LAYER][16] = {{0}};
+    for (int j = 0; j < A_NUM_COLS; j++) {
+        weights[HIDDEN_LAYER_FIRST_NEURON][j] = weights[HIDDEN_LAYER_FIRST_NEURON][8 + j] = recv_b_matrix[B_DISREGARD_BIAS_TERM + (j*NUM_NEURONS_HIDDEN_LAYER)];
+        weights[HIDDEN_LAYER_SECOND_NEURON][j] = weights[HIDDEN_LAYER_SECOND_NEURON][8 + j] = recv_b_matrix[B_DISREGARD_BIAS_TERM + B_OFFSET_FOR_SECOND_NEURON + (j*NUM_NEURONS_HIDDEN_LAYER)];
+    }
+    uint8x16_t weights_1 = vld1q_u8(weights[HIDDEN_LAYER_FIRST_NEURON]);
+    uint8x16_t weights_2 = vld1q_u8(weights[HIDDEN_LAYER_SECOND_NEURON]);
+    uint8x8_t weight_out_1 = vdup_n_u8(recv_c_matrix[C_DISREGARD_BIAS_TERM]);
+    uint8x8_t weight_out_2 = vdup_n_u8(recv_c_matrix[C_DISREGARD_BIAS_TERM + 1]);
+
+    int i = first_row;
+    for (; i + SOFT_SIMD_BLOCK_ROWS <= end_row; i += SOFT_SIMD_BLOCK_ROWS) {
+        uint8x16_t rows[SOFT_SIMD_BLOCK_ROWS/2];
+        neon_load_rows(&recv_a_matrix[i*A_NUM_COLS], rows);
+
+        /**************************** HIDDEN LAYER ************************************/
+        uint8x8_t hidden_1 = neon_neuron(neon_dot_rows(rows[0], rows[1], weights_1), neon_dot_rows(rows[2], rows[3], weights_1),
+                                         recv_b_matrix[HIDDEN_LAYER_FIRST_NEURON]);
+        uint8x8_t hidden_2 = neon_neuron(neon_dot_rows(rows[0], rows[1], weights_2), neon_dot_rows(rows[2], rows[3], weights_2),
+                                         recv_b_matrix[HIDDEN_LAYER_SECOND_NEURON]);
+        vst1_u8(&SOFT_hidden_layer_neurons[HIDDEN_LAYER_FIRST_NEURON][i], hidden_1);
+        vst1_u8(&SOFT_hidden_layer_neurons[HIDDEN_LAYER_SECOND_NEURON][i], hidden_2);
+
+        /**************************** OUTPUT LAYER ************************************/
+        // Both products are u16, their sum may not be, widen while adding
+        uint16x8_t product_1 = vmull_u8(hidden_1, weight_out_1);
+        uint16x8_t product_2 = vmull_u8(hidden_2, weight_out_2);
+        uint32x4_t sum_lo = vaddl_u16(vget_low_u16(product_1), vget_low_u16(product_2));
+        uint32x4_t sum_hi = vaddl_high_u16(product_1, product_2);
+
+        vst1_u8(&SOFT_output_layer_neurons[i], neon_neuron(sum_lo, sum_hi, recv_c_matrix[0]));
+    }
+
+    // Datapoints left over after the last full block
+    if (i < end_row) SOFT_processing(recv_a_matrix, recv_b_matrix, recv_c_matrix, SOFT_hidden_layer_neurons, SOFT_output_layer_neurons, i, end_row);
+}
+#endif
+
+/*********************************** GCC vector extensions *********************************************/
+#ifdef SOFT_SIMD_VECTOR
+typedef u32 soft_v8u32 __attribute__ ((vector_size (SOFT_SIMD_BLOCK_ROWS*sizeof(u32))));
+
+// Vectors go by pointer, 32 bytes by value would depend on the target having AVX (-Wpsabi)
+static inline void vector_pairwise_add(soft_v8u32* sum, soft_v8u32* a, soft_v8u32* b) {
+    // Sums of adjacent lanes, those of a then those of b
+    const soft_v8u32 even = {0, 2, 4, 6, 8, 10, 12, 14};
+    const soft_v8u32 odd = {1, 3, 5, 7, 9, 11, 13, 15};
+
+    *sum = __builtin_shuffle(*a, *b, even) + __builtin_shuffle(*a, *b, odd);
+}
+
+static inline void vector_load(soft_v8u32* loaded, int* words) {
+    // Unaligned load of 8 words, truncated like the (u8) of the scalar code
+    memcpy(loaded, words, sizeof(*loaded));
+    *loaded &= 0xFF;
+}
+
+static inline void vector_dot_rows(soft_v8u32* dot, soft_v8u32* datapoints, soft_v8u32* weights, soft_v8u32* weights_last) {
+    // Sums of the 8 datapoints (one per lane): products in place, then pairwise added until one sum per datapoint is left
+    soft_v8u32 sums[SOFT_SIMD_BLOCK_ROWS];
+
+    for (int k = 0; k < SOFT_SIMD_BLOCK_ROWS - 1; k++) {
+        sums[k] = datapoints[k] * *weights;
+    }
+    sums[SOFT_SIMD_BLOCK_ROWS - 1] = datapoints[SOFT_SIMD_BLOCK_ROWS - 1] * *weights_last;
+
+    for (int width = SOFT_SIMD_BLOCK_ROWS; width > 1; width /= 2) {
+        for (int k = 0; k < width/2; k++) {
+            vector_pairwise_add(&sums[k], &sums[2*k], &sums[2*k + 1]);
+        }
+    }
+
+    *dot = sums[0];
+}
+
+void SOFT_processing_vector(int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix,
+                            u8 (*SOFT_hidden_layer_neurons)[A_NUM_ROWS], u8* SOFT_output_layer_neurons, int first_row, int end_row) {
+    // Same scheme as NEON: one datapoint per vector (7 features and a lane whose weight is 0), then pairwise sums
+    // The last datapoint of a block is loaded one word early (weights shifted by one lane), so no load goes past the block
+    soft_v8u32 weights_1 = {0}, weights_1_last = {0};
+    soft_v8u32 weights_2 = {0}, weights_2_last = {0};
+    for (int j = 0; j < A_NUM_COLS; j++) {
+        weights_1[j] = weights_1_last[j + 1] = recv_b_matrix[B_DISREGARD_BIAS_TERM + (j*NUM_NEURONS_HIDDEN_LAYER)];
+        weights_2[j] = weights_2_last[j + 1] = recv_b_matrix[B_DISREGARD_BIAS_TERM + B_OFFSET_FOR_SECOND_NEURON + (j*NUM_NEURONS_HIDDEN_LAYER)];
+    }
+
+    int i = first_row;
+    for (; i + SOFT_SIMD_BLOCK_ROWS <= end_row; i += SOFT_SIMD_BLOCK_ROWS) {
+        int* rows = &recv_a_matrix[i*A_NUM_COLS];
+        soft_v8u32 datapoints[SOFT_SIMD_BLOCK_ROWS];
+
+        for (int k = 0; k < SOFT_SIMD_BLOCK_ROWS - 1; k++) {
+            vector_load(&datapoints[k], &rows[k*A_NUM_COLS]);
+        }
+        vector_load(&datapoints[SOFT_SIMD_BLOCK_ROWS - 1], &rows[(SOFT_SIMD_BLOCK_ROWS - 1)*A_NUM_COLS - 1]);
+
+        /**************************** HIDDEN LAYER ************************************/
+        soft_v8u32 hidden_1, hidden_2;
+        vector_dot_rows(&hidden_1, datapoints, &weights_1, &weights_1_last);
+        vector_dot_rows(&hidden_2, datapoints, &weights_2, &weights_2_last);
+
+        // Low 8 bits kept, as storing into u8 does
+        hidden_1 = ((hidden_1 + (u32)recv_b_matrix[HIDDEN_LAYER_FIRST_NEURON]) >> NUM_FRACTIONAL_BITS) & 0xFF;
+        hidden_2 = ((hidden_2 + (u32)recv_b_matrix[HIDDEN_LAYER_SECOND_NEURON]) >> NUM_FRACTIONAL_BITS) & 0xFF;
+
+        /**************************** OUTPUT LAYER ************************************/
+        soft_v8u32 sum = hidden_1 * (u32)recv_c_matrix[C_DISREGARD_BIAS_TERM] + hidden_2 * (u32)recv_c_matrix[C_DISREGARD_BIAS_TERM + 1];
+        soft_v8u32 output = (sum + (u32)recv_c_matrix[0]) >> NUM_FRACTIONAL_BITS;
+
+        for (int k = 0; k < SOFT_SIMD_BLOCK_ROWS; k++) {
+            SOFT_hidden_layer_neurons[HIDDEN_LAYER_FIRST_NEURON][i + k] = hidden_1[k];
+            SOFT_hidden_layer_neurons[HIDDEN_LAYER_SECOND_NEURON][i + k] = hidden_2[k];
+            SOFT_output_layer_neurons[i + k] = output[k];
+        }
+    }
+
+    // Datapoints left over after the last full block
+    if (i < end_row) SOFT_processing(recv_a_matrix, recv_b_matrix, recv_c_matrix, SOFT_hidden_layer_neurons, SOFT_output_layer_neurons, i, end_row);
+}
+#endif
+
+/*********************************** Dispatch *********************************************/
+void SOFT_processing_simd(int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix,
+                          u8 (*SOFT_hidden_layer_neurons)[A_NUM_ROWS], u8* SOFT_output_layer_neurons, int first_row, int end_row) {
+    #if defined(SOFT_SIMD_NEON)
+        SOFT_processing_neon(recv_a_matrix, recv_b_matrix, recv_c_matrix, SOFT_hidden_layer_neurons, SOFT_output_layer_neurons, first_row, end_row);
+    #elif defined(SOFT_SIMD_VECTOR)
+        SOFT_processing_vector(recv_a_matrix, recv_b_matrix, recv_c_matrix, SOFT_hidden_layer_neurons, SOFT_output_layer_neurons, first_row, end_row);
+    #else
+        SOFT_processing(recv_a_matrix, recv_b_matrix, recv_c_matrix, SOFT_hidden_layer_neurons, SOFT_output_layer_neurons, first_row, end_row);
+    #endif
+}
+
+/*********************************** Benchmark *********************************************/
+int soft_simd_benchmark(XTmrCtr* TimerCtrInstancePtr, int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix) {
+    // Runs the whole A matrix SOFT_SIMD_BENCHMARK_REPEATS times through every backend, each must match the scalar one bit for bit
+    static u8 reference_hidden[NUM_NEURONS_HIDDEN_LAYER][A_NUM_ROWS];
+    static u8 reference_output[A_NUM_ROWS];
+    static u8 hidden[NUM_NEURONS_HIDDEN_LAYER][A_NUM_ROWS];
+    static u8 output[A_NUM_ROWS];
+
+    struct {
+        const char* name;
+        soft_kernel kernel;
+    } backends[] = {
+        {"scalar", SOFT_processing},
+        #ifdef SOFT_SIMD_NEON
+            {"NEON", SOFT_processing_neon},
+        #endif
+        #ifdef SOFT_SIMD_VECTOR
+            {"GCC vector", SOFT_processing_vector},
+        #endif
+    };
+
+    SOFT_processing(recv_a_matrix, recv_b_matrix, recv_c_matrix, reference_hidden, reference_output, 0, A_NUM_ROWS);
+
+    for (int b = 0; b < sizeof(backends)/sizeof(backends[0]); b++) {
+        timer_restart(TimerCtrInstancePtr);
+        u32 start_time = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0);
+        for (int repeat = 0; repeat < SOFT_SIMD_BENCHMARK_REPEATS; repeat++) {
+            backends[b].kernel(recv_a_matrix, recv_b_matrix, recv_c_matrix, hidden, output, 0, A_NUM_ROWS);
+        }
+        u32 cycles = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0) - start_time;
+
+        for (int i = 0; i < A_NUM_ROWS; i++) {
+            if (output[i] != reference_output[i] || hidden[HIDDEN_LAYER_FIRST_NEURON][i] != reference_hidden[HIDDEN_LAYER_FIRST_NEURON][i]
+                                                 || hidden[HIDDEN_LAYER_SECOND_NEURON][i] != reference_hidden[HIDDEN_LAYER_SECOND_NEURON][i]) {
+                xil_printf("SOFT %s differs from scalar at datapoint %d\n", backends[b].name, i);
+                return XST_FAILURE;
+            }
+        }
+
+        u32 num_rows = A_NUM_ROWS*SOFT_SIMD_BENCHMARK_REPEATS;
+        u32 rows_per_second = (cycles == 0) ? 0 : (u32)(((u64)num_rows*XPAR_TMRCTR_0_CLOCK_FREQ_HZ) / cycles);
+        xil_printf("SOFT %s: %d rows in %d cycles, %d rows/s\n", backends[b].name, num_rows, cycles, rows_per_second);
+    }
+
+    return XST_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef COMMON_HEADER
+    #define COMMON_HEADER
+    #include "common.h"
+#endif
+
+#include "xtmrctr.h"
+
+// Vectorized SOFT_processing, bit-exact with it (u8 features and weights, u32 sums, results truncated to u8 like the scalar code)
+// Backends
+//  - NEON (Cortex-A53), 8 datapoints per block: widening 8x8->16 multiplies, pairwise accumulation into 32 bits
+//  - GCC vector extensions, same scheme in 32-bit lanes, any GCC target (SSE2/AVX2 on the x86 host build)
+// SOFT_processing_simd picks the best one available, the scalar SOFT_processing takes the rows left over after the last block
+//#define SOFT_SIMD
+//#define SOFT_SIMD_BENCHMARK     // Rows per second of every backend, before the normal run
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define SOFT_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+#if defined(__GNUC__)
+    #define SOFT_SIMD_VECTOR
+#endif
+
+#define SOFT_SIMD_BLOCK_ROWS            8
+#define SOFT_SIMD_BENCHMARK_REPEATS     1000
+
+typedef void (*soft_kernel)(int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix,
+                            u8 (*SOFT_hidden_layer_neurons)[A_NUM_ROWS], u8* SOFT_output_layer_neurons, int first_row, int end_row);
+
+// Scalar reference, in main.c
+void SOFT_processing(int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix, u8 (*SOFT_hidden_layer_neurons)[A_NUM_ROWS], u8* SOFT_output_layer_neurons, int first_row, int end_row);
+
+void SOFT_processing_simd(int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix, u8 (*SOFT_hidden_layer_neurons)[A_NUM_ROWS], u8* SOFT_output_layer_neurons, int first_row, int end_row);
+#ifdef SOFT_SIMD_NEON
+void SOFT_processing_neon(int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix, u8 (*SOFT_hidden_layer_neurons)[A_NUM_ROWS], u8* SOFT_output_layer_neurons, int first_row, int end_row);
+#endif
+#ifdef SOFT_SIMD_VECTOR
+void SOFT_processing_vector(int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix, u8 (*SOFT_hidden_layer_neurons)[A_NUM_ROWS], u8* SOFT_output_layer_neurons, int first_row, int end_row);
+#endif
+
+int soft_simd_benchmark(XTmrCtr* TimerCtrInstancePtr, int* recv_a_matrix, int* recv_b_matrix, int* recv_c_matrix);
\ No newline at end of file
@@ -1,8 +1,9 @@
 #include "timer.h"
 
+static int timer_cascaded = 0;
 
 int init_timer(XTmrCtr* TimerCtrInstancePtr) {
-    // NOTE: Only Timer0 is enabled in Vivado block diagram
+    // NOTE: Only Timer0 is enabled in Vivado block diagram (wrapper.xsa), init_timer_cascade checks for Timer 2
     int status;
 
     // Baseline initialization of AXI-Timer. Namely...
@@ -20,4 +21,48 @@ int init_timer(XTmrCtr* TimerCtrInstancePtr) {
 	XTmrCtr_SetOptions(TimerCtrInstancePtr, TIMER_CNTR_0, XTC_AUTO_RELOAD_OPTION);
 
     return XST_SUCCESS;
+}
+
+static int timer1_present(XTmrCtr* TimerCtrInstancePtr) {
+    // Without "Enable Timer 2" (C_ONE_TIMER_ONLY) TLR1/TCR1 read as 0, so a value loaded into TCR1 does not stick
+    XTmrCtr_SetResetValue(TimerCtrInstancePtr, TIMER_CNTR_1, TIMER_PROBE_VALUE);
+    XTmrCtr_Reset(TimerCtrInstancePtr, TIMER_CNTR_1);
+    int present = (XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_1) == TIMER_PROBE_VALUE);
+
+    XTmrCtr_SetResetValue(TimerCtrInstancePtr, TIMER_CNTR_1, 0);
+    XTmrCtr_Reset(TimerCtrInstancePtr, TIMER_CNTR_1);
+    return present;
+}
+
+int init_timer_cascade(XTmrCtr* TimerCtrInstancePtr) {
+    // Timer0 and Timer1 count as one 64-bit up-counter (TCR1:TCR0), never wraps in practice
+    // Only Timer0's control bits are used in cascade mode, its 32-bit value stays the low word, so XTmrCtr_GetValue differences still work
+    if (!timer1_present(TimerCtrInstancePtr)) {
+        xil_printf("AXI-Timer has no Timer 2, enable it in the block diagram for the 64-bit counter\n");
+        return XST_FAILURE;
+    }
+
+    XTmrCtr_SetOptions(TimerCtrInstancePtr, TIMER_CNTR_0, XTmrCtr_GetOptions(TimerCtrInstancePtr, TIMER_CNTR_0) | XTC_CASCADE_MODE_OPTION);
+    XTmrCtr_Start(TimerCtrInstancePtr, TIMER_CNTR_0);
+    timer_cascaded = 1;
+
+    return XST_SUCCESS;
+}
+
+void timer_restart(XTmrCtr* TimerCtrInstancePtr) {
+    // Start Timer0 from 0 (TLR0), callers take differences of XTmrCtr_GetValue from then on
+    // Cascaded, the 64-bit count runs from initialization and spans may be open, so it is left alone
+    if (!timer_cascaded) XTmrCtr_Start(TimerCtrInstancePtr, TIMER_CNTR_0);
+}
+
+u64 timer_get_value64(XTmrCtr* TimerCtrInstancePtr) {
+    // Upper word is read again after the lower one, if it moved the lower word wrapped in between, read both again
+    u32 upper, lower;
+
+    do {
+        upper = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_1);
+        lower = XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_0);
+    } while (upper != XTmrCtr_GetValue(TimerCtrInstancePtr, TIMER_CNTR_1));
+
+    return ((u64)upper << 32) | lower;
 }
\ No newline at end of file
@@ -7,5 +7,10 @@
 
 #define TMRCTR_DEVICE_ID        XPAR_TMRCTR_0_DEVICE_ID
 #define TIMER_CNTR_0            0
+#define TIMER_CNTR_1            1       // Only used cascaded with Timer0, needs "Enable Timer 2" of the AXI-Timer in the block diagram
+#define TIMER_PROBE_VALUE       0x5A5A5A5A
 
-int init_timer(XTmrCtr* TimerCtrInstancePtr);
\ No newline at end of file
+int init_timer(XTmrCtr* TimerCtrInstancePtr);
+int init_timer_cascade(XTmrCtr* TimerCtrInstancePtr);
+u64 timer_get_value64(XTmrCtr* TimerCtrInstancePtr);
+void timer_restart(XTmrCtr* TimerCtrInstancePtr);
\ No newline at end of file
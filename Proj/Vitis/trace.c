@@ -0,0 +1,48 @@
+#include "trace.h"
+#include "uart.h"
+
+static trace_record trace_ring[TRACE_RING_SIZE];
+static volatile u32 trace_head = 0;        // Records written so far, the last TRACE_RING_SIZE of them are in the ring
+
+void trace_write(u16 event, u16 arg0, u32 arg1, u32 arg2) {
+    // Slot is claimed with an exclusive load/store, an ISR tracing in between simply gets the next one
+    // Its timestamp may then be a little older than this one, the decoder allows for that
+    trace_record* record = &trace_ring[__atomic_fetch_add(&trace_head, 1, __ATOMIC_RELAXED) & (TRACE_RING_SIZE-1)];
+    XTime now;
+    XTime_GetTime(&now);
+
+    record->timestamp = (u32)now;
+    record->event = event;
+    record->arg0 = arg0;
+    record->arg1 = arg1;
+    record->arg2 = arg2;
+}
+
+u32 trace_num_records() {
+    return trace_head;
+}
+
+static void put_u32(u8* bytes, u32 value) {
+    // Little endian, like the records themselves
+    for (int k = 0; k < 4; k++) {
+        bytes[k] = (u8)(value >> (8*k));
+    }
+}
+
+void trace_dump(u32 uart_base_addr) {
+    // | magic (4) | records in the dump (u32) | records dropped (u32) | COUNTS_PER_SECOND (u32) | records, oldest first |
+    // Nothing may be tracing meanwhile, it is only called once the run is over
+    u32 num_written = trace_head;
+    u32 num_records = (num_written < TRACE_RING_SIZE) ? num_written : TRACE_RING_SIZE;
+    u8 header[16] = TRACE_DUMP_MAGIC;
+
+    put_u32(&header[4], num_records);
+    put_u32(&header[8], num_written - num_records);
+    put_u32(&header[12], COUNTS_PER_SECOND);
+    send_bytes(uart_base_addr, header, sizeof(header));
+
+    for (u32 k = num_written - num_records; k != num_written; k++) {
+        send_bytes(uart_base_addr, (u8*)&trace_ring[k & (TRACE_RING_SIZE-1)], sizeof(trace_record));
+    }
+    uart_tx_flush(uart_base_addr);
+}
\ No newline at end of file
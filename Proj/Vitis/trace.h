@@ -0,0 +1,73 @@
+#ifndef COMMON_HEADER
+    #define COMMON_HEADER
+    #include "common.h"
+#endif
+
+#include "xtime_l.h"
+
+// Binary trace: fixed-size records (timestamp, event, args) into a RAM ring, instead of xil_printf in ISRs and per-batch/per-word paths
+// A record costs a global timer read and 16 bytes of stores, the UART only sees the ring once the run is over
+// After the run the board waits for TRACE_DUMP_COMMAND, then streams the ring out raw (header, then the records oldest first)
+// host/trace_decode.py finds the dump in a capture of the UART output, prints it as text or writes a Chrome trace (chrome://tracing)
+//#define TRACE
+
+// Records above TRACE_LEVEL are compiled out, their arguments are not even evaluated
+#define TRACE_LEVEL_ERROR       1
+#define TRACE_LEVEL_INFO        2       // Per batch, per interrupt
+#define TRACE_LEVEL_DEBUG       3       // Per chunk, per word
+#ifndef TRACE_LEVEL
+    #define TRACE_LEVEL         TRACE_LEVEL_INFO
+#endif
+
+#define TRACE_RING_SIZE         1024    // Records, power of 2. The ring keeps the latest ones, older ones are counted as dropped
+#define TRACE_DUMP_MAGIC        "TRCE"
+#define TRACE_DUMP_COMMAND      't'
+
+// Must match EVENTS of host/trace_decode.py, _BEGIN/_END pairs become spans of the Chrome trace
+typedef enum {
+    TRACE_HARD_BEGIN = 0,       // arg0: batches
+    TRACE_HARD_END,
+    TRACE_BATCH_BEGIN,          // arg0: batch
+    TRACE_BATCH_END,            // arg0: batch
+    TRACE_AXIS_TX_CHUNK,        // arg0: batch, arg1: words
+    TRACE_AXIS_RX_IRQ,          // arg0: batch (ISR)
+    TRACE_AXIS_RX_COPY,         // arg0: batch, arg1: bytes, arg2: cycles since the interrupt
+    TRACE_AXIS_RX_POLL,         // arg0: batch, arg1: polls until the packet was in
+    TRACE_AXIS_RX_TIMEOUT,      // arg0: batch
+    TRACE_DMA_MM2S_IRQ,         // arg0: next batch to send (ISR)
+    TRACE_DMA_S2MM_IRQ,         // arg0: batch received (ISR)
+    TRACE_DMA_ERROR,            // arg0: channel (0 MM2S, 1 S2MM), arg1: IRQ status
+    TRACE_BACKEND_SWITCH,       // arg0: command character of the new backend
+    TRACE_VERIFY_WORD,          // arg0: word, arg1: result, arg2: expected
+    TRACE_VERIFY_MISMATCH,      // arg0: word, arg1: result, arg2: expected
+    TRACE_MODEL_UPLOAD,         // arg0: model handle, arg1: model id
+    TRACE_NUM_EVENTS
+} trace_event;
+
+typedef struct {
+    u32 timestamp;              // Low word of the global timer (COUNTS_PER_SECOND), the decoder unwraps it
+    u16 event;
+    u16 arg0;
+    u32 arg1;
+    u32 arg2;
+} trace_record;
+
+#if defined(TRACE) && TRACE_LEVEL >= TRACE_LEVEL_ERROR
+    #define TRACE_ERROR(event, arg0, arg1, arg2)    trace_write(event, arg0, arg1, arg2)
+#else
+    #define TRACE_ERROR(event, arg0, arg1, arg2)
+#endif
+#if defined(TRACE) && TRACE_LEVEL >= TRACE_LEVEL_INFO
+    #define TRACE_INFO(event, arg0, arg1, arg2)     trace_write(event, arg0, arg1, arg2)
+#else
+    #define TRACE_INFO(event, arg0, arg1, arg2)
+#endif
+#if defined(TRACE) && TRACE_LEVEL >= TRACE_LEVEL_DEBUG
+    #define TRACE_DEBUG(event, arg0, arg1, arg2)    trace_write(event, arg0, arg1, arg2)
+#else
+    #define TRACE_DEBUG(event, arg0, arg1, arg2)
+#endif
+
+void trace_write(u16 event, u16 arg0, u32 arg1, u32 arg2);
+u32 trace_num_records();
+void trace_dump(u32 uart_base_addr);
\ No newline at end of file
@@ -25,22 +25,17 @@ void override_uart_configs(XUartPs* Uart_Ps_ptr) {
 }
 
 
-void receive_from_realterm(u32 uart_base_addr, char* recv_a_matrix, char* recv_b_matrix, char* recv_c_matrix, int* HARD_input_memory) {
+void receive_from_realterm(u32 uart_base_addr, int* HARD_input_memory) {
     // Data is sent through .csv files via Realterm
     // .csv files MUST be in Unix format (i.e consider line break as 0xA). Can use Vim to set fileformat to Unix.
     // Also note that the file MUST have EOL character. Can use Vim to check also.
-
-    int valid_recv_count = 0;    // Number of elements in our usual Matrix
-
-    char buffer[CONCAT_BUFFER_SIZE] = {0};  // Maximal incoming matrix value is '255', formed by 3 chars
-    int num_insertions = 0;
+    uart_parser parser;
+    uart_parser_init(&parser, A_OFFSET);
 
     while(1) {
         // Check if all valid data has been received
         // Note that we need to check BEFORE we begin RX polling
-        if (valid_recv_count == (A_NUM_ROWS*A_NUM_COLS)
-                              + (B_NUM_ROWS*B_NUM_COLS)
-                              + (C_NUM_ROWS*C_NUM_COLS)) return;
+        if (parser.valid_recv_count == NUMBER_OF_INPUT_WORDS) return;
 
         // Polling until any data is received
         while (!XUartPs_IsReceiveData(uart_base_addr));
@@ -48,92 +43,381 @@ void receive_from_realterm(u32 uart_base_addr, char* recv_a_matrix, char* recv_b
         // Read from Transmit and Receive FIFO[7:0]
         u8 recv_char = XUartPs_ReadReg(uart_base_addr, XUARTPS_FIFO_OFFSET);
 
-        // Parse the data accordingly
-        if (recv_char == NEW_LINE || recv_char == COMMA) {
-            // Newline, means we are going to 'next row' of matrix
-            // Comma, means we are transitioning to next matrix 'element'
-            u8 concat_char = concat_char_buffer(buffer, num_insertions-1);
-
-            // Concat all data into one array, which will be sent over to PL
-            *HARD_input_memory = concat_char;
-            HARD_input_memory++;
-
-            // Split incoming data into A,B,C matrix
-            if (valid_recv_count < A_NUM_ROWS*A_NUM_COLS) {
-                *recv_a_matrix = concat_char;
-                recv_a_matrix++;
-            } 
-            else if (A_NUM_ROWS*A_NUM_COLS <= valid_recv_count 
-                    && valid_recv_count < A_NUM_ROWS*A_NUM_COLS + B_NUM_ROWS*B_NUM_COLS) {
-                *recv_b_matrix = concat_char;
-                recv_b_matrix++;
-            }
-            else {
-                *recv_c_matrix = concat_char;
-                recv_c_matrix++;
-            }
+        uart_parse_char(&parser, recv_char, HARD_input_memory);
+    }
+}
 
-            // Book-keeping before continuing to next loop
-            valid_recv_count++;
-            num_insertions = 0;
-        }
-        else if (0x30 <= recv_char && recv_char <= 0x39) {
-            // Received VALID char that forms up matrix element
-            // e.g integer '46' is formed from chars '4' , '6'
-            buffer[num_insertions] = recv_char;
-            num_insertions++;
+
+char receive_command(u32 uart_base_addr) {
+    // One command character typed after the files (backend.h, trace.h), line endings and spaces are skipped
+    while (1) {
+        while (!XUartPs_IsReceiveData(uart_base_addr));
+
+        char command = XUartPs_ReadReg(uart_base_addr, XUARTPS_FIFO_OFFSET);
+        if (command != ' ' && command != '\r' && command != '\n') return command;
+    }
+}
+
+
+void uart_parser_init(uart_parser* parser, int first_value) {
+    parser->num_insertions = 0;
+    parser->valid_recv_count = 0;
+    parser->first_value = first_value;
+    parser->row = -1;
+}
+
+
+int uart_parse_char(uart_parser* parser, u8 recv_char, int* HARD_input_memory) {
+    // Resumable, all state lives in the parser so characters can come in any number of calls
+    // Parse the data accordingly
+    if (recv_char == NEW_LINE || recv_char == COMMA) {
+        // Newline, means we are going to 'next row' of matrix
+        // Comma, means we are transitioning to next matrix 'element'
+        u8 concat_char = concat_char_buffer(parser->buffer, parser->num_insertions-1);
+
+        // Concat all data into one array, which will be sent over to PL
+        // This is the only copy, SOFT reads the A,B,C matrices straight out of it (see A_OFFSET, B_OFFSET, C_OFFSET)
+        int word = (parser->first_value + parser->valid_recv_count) % NUMBER_OF_INPUT_WORDS;
+        HARD_input_memory[word] = concat_char;
+
+        // Book-keeping before continuing to next char
+        parser->valid_recv_count++;
+        parser->num_insertions = 0;
+
+        // Weights are the words from B_OFFSET to the end, each datapoint is A_NUM_COLS words before B_OFFSET
+        if (word == NUMBER_OF_INPUT_WORDS-1) return UART_EVENT_WEIGHTS_READY;
+        if (word < B_OFFSET && (word - A_OFFSET) % A_NUM_COLS == A_NUM_COLS-1) {
+            parser->row = (word - A_OFFSET) / A_NUM_COLS;
+            return UART_EVENT_ROW_COMPLETE;
         }
-        else {
-            // Some invalid character, print error
-            xil_printf("DETECTED INVALID CHARACTER %c\n", recv_char);
+        return UART_EVENT_VALUE;
+    }
+    else if (0x30 <= recv_char && recv_char <= 0x39) {
+        // Received VALID char that forms up matrix element
+        // e.g integer '46' is formed from chars '4' , '6'
+        parser->buffer[parser->num_insertions] = recv_char;
+        parser->num_insertions++;
+    }
+    else {
+        // Some invalid character, print error
+        xil_printf("DETECTED INVALID CHARACTER %c\n", recv_char);
+    }
+
+    return UART_EVENT_NONE;
+}
+
+
+#ifdef UART_RX_INTERRUPT_MODE
+// Single producer (ISR), single consumer (main loop): head is only written by the ISR, tail only by the consumer
+// Both are free running, the ring is never locked nor are interrupts masked to access it
+static volatile u8 rx_ring[UART_RX_RING_SIZE];
+static volatile u32 rx_ring_head = 0;
+static volatile u32 rx_ring_tail = 0;
+static volatile u32 rx_ring_overflows = 0;
+
+
+void start_uart_rx_interrupt(XUartPs* Uart_Ps_ptr) {
+    // Interrupt on RX FIFO trigger level, and on timeout so the tail of a burst is not left in the FIFO
+    XUartPs_SetFifoThreshold(Uart_Ps_ptr, UART_RX_FIFO_TRIGGER);
+    XUartPs_SetRecvTimeout(Uart_Ps_ptr, UART_RX_TIMEOUT);
+    XUartPs_SetInterruptMask(Uart_Ps_ptr, XUARTPS_IXR_RXOVR | XUARTPS_IXR_TOUT | XUARTPS_IXR_OVER);
+}
+
+
+static void uart_rx_drain(u32 uart_base_addr, u32 Pending) {
+    // Drain the whole RX FIFO, whatever the source (trigger, timeout or hardware overrun)
+    u32 head = rx_ring_head;
+    while (XUartPs_IsReceiveData(uart_base_addr)) {
+        u8 recv_char = XUartPs_ReadReg(uart_base_addr, XUARTPS_FIFO_OFFSET);
+
+        if (head - rx_ring_tail == UART_RX_RING_SIZE) {
+            rx_ring_overflows++;
+            continue;
         }
+        rx_ring[head & (UART_RX_RING_SIZE-1)] = recv_char;
+        head++;
+    }
+    // Publish after the data, single core so volatile ordering is enough
+    rx_ring_head = head;
+
+    if (Pending & XUARTPS_IXR_OVER) rx_ring_overflows++;
+}
+
 
+int uart_rx_next_event(uart_parser* parser, int* HARD_input_memory) {
+    // Parses what the ISR has queued so far, up to the next row complete / weights ready event
+    // Returns UART_EVENT_NONE once the ring is empty, call again later
+    u32 head = rx_ring_head;
+    u32 tail = rx_ring_tail;
+    int event = UART_EVENT_NONE;
+
+    while (tail != head && parser->valid_recv_count < NUMBER_OF_INPUT_WORDS) {
+        event = uart_parse_char(parser, rx_ring[tail & (UART_RX_RING_SIZE-1)], HARD_input_memory);
+        tail++;
+
+        if (event == UART_EVENT_ROW_COMPLETE || event == UART_EVENT_WEIGHTS_READY) break;
+        event = UART_EVENT_NONE;
     }
+    // Hand the slots back to the ISR only once they are parsed
+    rx_ring_tail = tail;
+
+    return event;
+}
+
+
+u32 uart_rx_num_overflows() {
+    return rx_ring_overflows;
+}
+#endif
+
+
+static u8 uart_read_byte(u32 uart_base_addr) {
+    while (!XUartPs_IsReceiveData(uart_base_addr));
+
+    return XUartPs_ReadReg(uart_base_addr, XUARTPS_FIFO_OFFSET);
+}
+
+
+static void uart_write_byte(u32 uart_base_addr, u8 data) {
+    while (XUartPs_IsTransmitFull(uart_base_addr));
+
+    XUartPs_WriteReg(uart_base_addr, XUARTPS_FIFO_OFFSET, data);
+}
+
+
+static int uart_wait_data(u32 uart_base_addr, u32 timeout_us) {
+    // Returns whether a byte arrived within 'timeout_us'
+    XTime start_time, now;
+
+    XTime_GetTime(&start_time);
+    while (!XUartPs_IsReceiveData(uart_base_addr)) {
+        XTime_GetTime(&now);
+        if (now - start_time > ((XTime)timeout_us * COUNTS_PER_SECOND) / 1000000) return FALSE;
+    }
+
+    return TRUE;
 }
 
 
-void send_to_realterm(u32 uart_base_address, int* trans_res_matrix) {
-    // Additional +1 to accomodate null-termination of strings
-    // Note string literals must be char, NOT unsigned char
-    char string[RESULT_BUFFER_SIZE+1] = {-1};   
+int receive_frames(u32 uart_base_addr, int* HARD_input_memory) {
+    // Returns the number of rejected frames, after every value of A and of the weights has been received
+    u8 header[FRAME_HEADER_SIZE];
+    u8 payload[FRAME_MAX_PAYLOAD];
+    int rows_received = 0;
+    int weights_received = 0;
+    int last_seq = -1;          // Retransmission of a frame whose ACK got lost is acknowledged but not stored twice
+    int num_rejected = 0;
+
+    crc32_init();
+
+    while (1) {
+        // Once everything is in, only a retransmission of the last frame (its ACK got lost) is waited for, and not for long
+        int complete = rows_received >= FRAME_ROWS_NUM_VALUES && weights_received >= FRAME_WEIGHTS_NUM_VALUES;
+
+        // Hunt for the sync pattern, anything in between (e.g a corrupt frame's leftovers) is skipped
+        u8 previous = 0;
+        u8 current = 0;
+        do {
+            if (complete && !uart_wait_data(uart_base_addr, FRAME_LINGER_US)) return num_rejected;
+            previous = current;
+            current = uart_read_byte(uart_base_addr);
+        } while (!(previous == FRAME_SYNC_0 && current == FRAME_SYNC_1));
+
+        for (int k = 0; k < FRAME_HEADER_SIZE; k++) {
+            header[k] = uart_read_byte(uart_base_addr);
+        }
+        u8 type = header[0];
+        u8 seq = header[1];
+        int length = header[2] | (header[3] << 8);
+        int offset = header[4] | (header[5] << 8);
+        int num_values = (type == FRAME_TYPE_ROWS) ? FRAME_ROWS_NUM_VALUES : FRAME_WEIGHTS_NUM_VALUES;
+
+        // Header is not trusted until the CRC matches, never read a length we can't hold
+        if ((type != FRAME_TYPE_ROWS && type != FRAME_TYPE_WEIGHTS) || length > FRAME_MAX_PAYLOAD || offset + length > num_values) {
+            num_rejected++;
+            uart_write_byte(uart_base_addr, FRAME_NAK);
+            continue;
+        }
 
-    for (int i = 0; i < A_NUM_ROWS*B_NUM_COLS; i++) {
-        // If external libraries not allowed, could just do mathematical operations on elements of trans_res_matrix
-        // char a = '278'
-        // string[0] == '2', string[1] == '7', string[2] == '8'
-        // char b = '78'
-        // string[0] == '7', string[1] == '8' 
-        // char c = '8'
-        // string[0] == '8'
-        sprintf(string, "%d", trans_res_matrix[i]);
+        for (int k = 0; k < length; k++) {
+            payload[k] = uart_read_byte(uart_base_addr);
+        }
+        u32 received_crc = 0;
+        for (int k = 0; k < FRAME_CRC_SIZE; k++) {
+            received_crc |= (u32)uart_read_byte(uart_base_addr) << (8*k);
+        }
 
-        // Common to all 1/2/3/4 digit numbers
-        while (XUartPs_IsTransmitFull(uart_base_address));
-        XUartPs_WriteReg(uart_base_address, XUARTPS_FIFO_OFFSET, string[0]);
+        u32 crc = crc32_update(CRC32_INITIAL, header, FRAME_HEADER_SIZE);
+        crc = crc32_update(crc, payload, length) ^ CRC32_FINAL_XOR;
+        if (crc != received_crc) {
+            num_rejected++;
+            uart_write_byte(uart_base_addr, FRAME_NAK);
+            continue;
+        }
+
+        if (seq != last_seq) {
+            // Values go straight into the ingest buffer, one word each
+            int* destination = HARD_input_memory + ((type == FRAME_TYPE_ROWS) ? A_OFFSET : B_OFFSET) + offset;
+            for (int k = 0; k < length; k++) {
+                destination[k] = payload[k];
+            }
 
-        // Common to all 2/3/4 digit numbers
-        if (trans_res_matrix[i] >= 10) {
-            while (XUartPs_IsTransmitFull(uart_base_address));
-            XUartPs_WriteReg(uart_base_address, XUARTPS_FIFO_OFFSET, string[1]);
+            if (type == FRAME_TYPE_ROWS) rows_received += length;
+            else weights_received += length;
+            last_seq = seq;
         }
+        uart_write_byte(uart_base_addr, FRAME_ACK);
+    }
+}
+
+
+// Same scheme as the RX ring, the other way round: main loop produces, ISR (or polling) consumes
+static volatile u8 tx_ring[UART_TX_RING_SIZE];
+static volatile u32 tx_ring_head = 0;
+static volatile u32 tx_ring_tail = 0;
+
+
+static void uart_tx_fill(u32 uart_base_addr) {
+    // Moves staged bytes into the TX FIFO until it is full, never waits
+    u32 tail = tx_ring_tail;
+
+    while (tail != tx_ring_head && !XUartPs_IsTransmitFull(uart_base_addr)) {
+        XUartPs_WriteReg(uart_base_addr, XUARTPS_FIFO_OFFSET, tx_ring[tail & (UART_TX_RING_SIZE-1)]);
+        tail++;
+    }
+    tx_ring_tail = tail;
+}
 
-        // Common to all 3/4 digit numbers
-        if (trans_res_matrix[i] >= 100) {
-            while (XUartPs_IsTransmitFull(uart_base_address));
-            XUartPs_WriteReg(uart_base_address, XUARTPS_FIFO_OFFSET, string[2]);
+
+static void uart_tx_start(u32 uart_base_addr) {
+    #ifdef UART_TX_INTERRUPT_MODE
+        // Interrupt fires right away if the TX FIFO is already empty, the ISR takes it from there
+        XUartPs_WriteReg(uart_base_addr, XUARTPS_IER_OFFSET, XUARTPS_IXR_TXEMPTY);
+    #else
+        while (tx_ring_tail != tx_ring_head) {
+            uart_tx_fill(uart_base_addr);
         }
+    #endif
+}
+
+
+static void uart_tx_put(u32 uart_base_addr, u8 data) {
+    u32 head = tx_ring_head;
+
+    // Only when more than UART_TX_RING_SIZE bytes are staged at once
+    while (head - tx_ring_tail == UART_TX_RING_SIZE) {
+        uart_tx_start(uart_base_addr);
+    }
+
+    tx_ring[head & (UART_TX_RING_SIZE-1)] = data;
+    tx_ring_head = head + 1;
+}
+
 
-        // Solely for 4 digit numbers
-        if (trans_res_matrix[i] >= 1000) {
-            while (XUartPs_IsTransmitFull(uart_base_address));
-            XUartPs_WriteReg(uart_base_address, XUARTPS_FIFO_OFFSET, string[3]);
+static void uart_tx_put_decimal(u32 uart_base_addr, u32 value) {
+    // Digits come out least significant first, so they are reversed on the way out
+    u8 digits[RESULT_MAX_DIGITS];
+    int num_digits = 0;
+
+    do {
+        digits[num_digits++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    while (num_digits > 0) {
+        uart_tx_put(uart_base_addr, digits[--num_digits]);
+    }
+}
+
+
+void send_results(u32 uart_base_addr, int* results, int first_value, int num_values) {
+    // Results of datapoints 'first_value' to 'first_value'+'num_values'-1, results[0] being the first of them
+    // Only formats into the staging ring, the bytes leave in the background (UART_TX_INTERRUPT_MODE)
+    #ifdef UART_BINARY_PROTOCOL
+        // Frames of at most FRAME_MAX_PAYLOAD bytes, 2 per result
+        static u8 seq = 0;
+
+        for (int sent = 0; sent < num_values; ) {
+            int count = num_values - sent;
+            if (count > FRAME_MAX_PAYLOAD/2) count = FRAME_MAX_PAYLOAD/2;
+
+            u8 header[FRAME_HEADER_SIZE] = {FRAME_TYPE_RESULTS, seq++, (u8)(2*count), (u8)((2*count) >> 8),
+                                            (u8)(first_value + sent), (u8)((first_value + sent) >> 8)};
+            u32 crc = crc32_update(CRC32_INITIAL, header, FRAME_HEADER_SIZE);
+
+            uart_tx_put(uart_base_addr, FRAME_SYNC_0);
+            uart_tx_put(uart_base_addr, FRAME_SYNC_1);
+            for (int k = 0; k < FRAME_HEADER_SIZE; k++) {
+                uart_tx_put(uart_base_addr, header[k]);
+            }
+            for (int k = 0; k < count; k++) {
+                u8 value[2] = {(u8)results[sent+k], (u8)(results[sent+k] >> 8)};
+                crc = crc32_update(crc, value, 2);
+                uart_tx_put(uart_base_addr, value[0]);
+                uart_tx_put(uart_base_addr, value[1]);
+            }
+            crc ^= CRC32_FINAL_XOR;
+            for (int k = 0; k < FRAME_CRC_SIZE; k++) {
+                uart_tx_put(uart_base_addr, (u8)(crc >> (8*k)));
+            }
+
+            sent += count;
+        }
+    #else
+        // One result per line, as Realterm shows them
+        for (int i = 0; i < num_values; i++) {
+            uart_tx_put_decimal(uart_base_addr, (u32)results[i]);
+            uart_tx_put(uart_base_addr, NEW_LINE);
         }
+    #endif
+
+    uart_tx_start(uart_base_addr);
+}
+
 
-        // Newline for next element
-        while (XUartPs_IsTransmitFull(uart_base_address));
-        XUartPs_WriteReg(uart_base_address, XUARTPS_FIFO_OFFSET, NEW_LINE);
+void send_bytes(u32 uart_base_addr, const u8* data, int num_bytes) {
+    // Raw bytes through the same staging ring as the results, e.g a trace dump
+    for (int k = 0; k < num_bytes; k++) {
+        uart_tx_put(uart_base_addr, data[k]);
     }
+
+    uart_tx_start(uart_base_addr);
+}
+
+
+void uart_tx_flush(u32 uart_base_addr) {
+    // Wait for every staged byte to be in the TX FIFO, e.g before xil_printf (which writes the TX FIFO directly)
+    while (tx_ring_tail != tx_ring_head) {
+        #ifdef UART_TX_INTERRUPT_MODE
+            asm("nop");
+        #else
+            uart_tx_fill(uart_base_addr);
+        #endif
+    }
+}
+
+
+#ifdef UART_INTERRUPTS_USED
+void uart_interrupt_handler(XUartPs* Uart_Ps_ptr) {
+    u32 uart_base_addr = Uart_Ps_ptr->Config.BaseAddress;
+    u32 Pending = XUartPs_ReadReg(uart_base_addr, XUARTPS_ISR_OFFSET) & XUartPs_ReadReg(uart_base_addr, XUARTPS_IMR_OFFSET);
+
+    #ifdef UART_RX_INTERRUPT_MODE
+        if (Pending & (XUARTPS_IXR_RXOVR | XUARTPS_IXR_TOUT | XUARTPS_IXR_OVER)) uart_rx_drain(uart_base_addr, Pending);
+    #endif
+
+    #ifdef UART_TX_INTERRUPT_MODE
+        if (Pending & XUARTPS_IXR_TXEMPTY) {
+            uart_tx_fill(uart_base_addr);
+
+            // Nothing left to stage, stop the interrupt until the next send_results
+            if (tx_ring_tail == tx_ring_head) XUartPs_WriteReg(uart_base_addr, XUARTPS_IDR_OFFSET, XUARTPS_IXR_TXEMPTY);
+        }
+    #endif
+
+    XUartPs_WriteReg(uart_base_addr, XUARTPS_ISR_OFFSET, Pending);
 }
+#endif
 
 
 char concat_char_buffer(char* buffer_ptr, int tail_index) {
@@ -4,23 +4,106 @@
 #endif
 
 #include "xuartps.h"
+#include "crc32.h"
+#include "xtime_l.h"
+
+// Binary framed input instead of .csv files through Realterm, sent with host/send_frames.py
+//  | 0xA5 | 0x5A | type | seq | length (u16) | offset (u16) | payload (length bytes) | CRC-32 (u32) |
+//  - type: FRAME_TYPE_ROWS (values of A) or FRAME_TYPE_WEIGHTS (B, C, then S, band in CASCADE_MODE)
+//  - offset: index of the first payload value within those values, one byte per value
+//  - CRC-32 covers type to the end of the payload, multi-byte fields are little endian
+//  - Every frame is answered with FRAME_ACK, or FRAME_NAK if it was corrupt (then the sender retransmits)
+//  - After the last frame the receiver stays FRAME_LINGER_US, the ACK of that frame may have been lost and it comes again
+//  - Results go back the same way, as FRAME_TYPE_RESULTS frames (not acknowledged)
+//#define UART_BINARY_PROTOCOL
+
+// Interrupt driven RX: the ISR drains the UART RX FIFO into a lock-free ring, the main loop parses out of it
+// and dispatches datapoints in micro-batches as soon as their rows are complete, while the rest is still on the wire
+// Files are sent weights first in this mode (w_hid.csv, w_out.csv, [w_screen.csv, screen_band.csv], then X.csv)
+//#define UART_RX_INTERRUPT_MODE
+
+// Results are formatted into a staging ring, then drained into the TX FIFO by the UART ISR (TX FIFO empty interrupt)
+// Otherwise the ring is drained by polling, right after formatting
+//#define UART_TX_INTERRUPT_MODE
+
+#if defined(UART_RX_INTERRUPT_MODE) || defined(UART_TX_INTERRUPT_MODE)
+    #define UART_INTERRUPTS_USED
+#endif
 
 #define UART_DEVICE_ID  XPAR_XUARTPS_0_DEVICE_ID
 #define UART_BASEADDR   XPAR_XUARTPS_0_BASEADDR
-#define MY_BAUD_RATE    115200  // Realterm must match this
+#ifdef UART_BINARY_PROTOCOL
+    #define MY_BAUD_RATE    921600  // host/send_frames.py must match this
+#else
+    #define MY_BAUD_RATE    115200  // Realterm must match this
+#endif
 #define NEW_LINE        0xA
 #define COMMA           0x2C
 #define CONCAT_BUFFER_SIZE 3
-#define RESULT_BUFFER_SIZE 4
+#define RESULT_MAX_DIGITS  10      // u32
 #define ONES        0
 #define TENS        1
 #define HUNDREDS    2
 
+#define UART_RX_RING_SIZE       1024    // Power of 2, bytes
+#define UART_RX_FIFO_TRIGGER    32      // RX FIFO is 64 bytes, interrupt when half full...
+#define UART_RX_TIMEOUT         8       // ...or after 8*4 bit periods without a new byte
+#define UART_RX_FIRST_VALUE     B_OFFSET    // Word of the ingest buffer the first received value goes to
+#define UART_TX_RING_SIZE       1024    // Power of 2, bytes. Holds a whole batch of results, text or framed
+
+// Parser events, uart_parse_char returns one per character
+#define UART_EVENT_NONE             0   // Nothing completed (digit, or invalid character)
+#define UART_EVENT_VALUE            1   // A value was stored
+#define UART_EVENT_ROW_COMPLETE     2   // Last value of datapoint parser->row was stored
+#define UART_EVENT_WEIGHTS_READY    3   // Last weight (B, C, then S, band in CASCADE_MODE) was stored
+
+#define FRAME_SYNC_0        0xA5
+#define FRAME_SYNC_1        0x5A
+#define FRAME_TYPE_ROWS     0x01
+#define FRAME_TYPE_WEIGHTS  0x02
+#define FRAME_TYPE_RESULTS  0x03    // Board to PC, results as u16, offset is the index of the first datapoint
+#define FRAME_HEADER_SIZE   6       // type, seq, length, offset
+#define FRAME_CRC_SIZE      4
+#define FRAME_MAX_PAYLOAD   256
+#define FRAME_ACK           0x06
+#define FRAME_NAK           0x15
+#define FRAME_LINGER_US     1000000 // Twice the ACK timeout of host/send_frames.py, restarted by every retransmission
+#define FRAME_ROWS_NUM_VALUES       (A_NUM_ROWS*A_NUM_COLS)
+#define FRAME_WEIGHTS_NUM_VALUES    (NUMBER_OF_INPUT_WORDS - B_OFFSET)
+// Results frames index their first datapoint with the u16 offset
+#if defined(UART_BINARY_PROTOCOL) && NUMBER_OF_TEST_VECTORS*NUMBER_OF_OUTPUT_WORDS > 65535
+    #error "UART_BINARY_PROTOCOL results frames carry a u16 offset, at most 65535 results per workload"
+#endif
+
+typedef struct {
+    char buffer[CONCAT_BUFFER_SIZE];    // Maximal incoming matrix value is '255', formed by 3 chars
+    int num_insertions;
+    int valid_recv_count;               // Number of values received so far
+    int first_value;                    // Word of the ingest buffer the first value goes to, wraps around to A_OFFSET
+    int row;                            // Datapoint of the last UART_EVENT_ROW_COMPLETE
+} uart_parser;
+
 int init_UART(XUartPs* Uart_Ps);
 void override_uart_configs(XUartPs* Uart_Ps);
 
-void receive_from_realterm(u32 uart_base_addr, char* recv_a_matrix, char* recv_b_matrix, char* recv_c_matrix, int* HARD_input_memory);
-void send_to_realterm(u32 uart_base_address, int* trans_res_matrix);
+void receive_from_realterm(u32 uart_base_addr, int* HARD_input_memory);
+char receive_command(u32 uart_base_addr);
+void send_results(u32 uart_base_addr, int* results, int first_value, int num_values);
+void send_bytes(u32 uart_base_addr, const u8* data, int num_bytes);
+void uart_tx_flush(u32 uart_base_addr);
+int receive_frames(u32 uart_base_addr, int* HARD_input_memory);
+
+void uart_parser_init(uart_parser* parser, int first_value);
+int uart_parse_char(uart_parser* parser, u8 recv_char, int* HARD_input_memory);
+
+#ifdef UART_INTERRUPTS_USED
+void uart_interrupt_handler(XUartPs* Uart_Ps);
+#endif
+#ifdef UART_RX_INTERRUPT_MODE
+void start_uart_rx_interrupt(XUartPs* Uart_Ps);
+int uart_rx_next_event(uart_parser* parser, int* HARD_input_memory);
+u32 uart_rx_num_overflows();
+#endif
 
 char concat_char_buffer(char* buffer_ptr, int tail_index);
 u8 find_place(u8 loop_iteration);
\ No newline at end of file